@@ -24,11 +24,445 @@ SOFTWARE.
 #pragma once
 #include <iostream>
 #include <x86intrin.h>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
 
 #if __cplusplus >= 201703L
 #include <string_view>
 #endif
 
+namespace str_detail {
+
+inline bool genericEQ(const char* p1, const char* p2, size_t len) {
+  while (len >= 8) {
+    if (*(uint64_t*)p1 != *(uint64_t*)p2) return false;
+    p1 += 8;
+    p2 += 8;
+    len -= 8;
+  }
+  if (len >= 4) {
+    if (*(uint32_t*)(p1) != *(uint32_t*)(p2)) return false;
+    p1 += 4;
+    p2 += 4;
+    len -= 4;
+  }
+  switch (len) {
+    case 1: return *p1 == *p2;
+    case 2: return *(uint16_t*)p1 == *(uint16_t*)p2;
+    case 3: return *(uint16_t*)p1 == *(uint16_t*)p2 && p1[2] == p2[2];
+  };
+  return true;
+}
+
+inline int genericCompare(const char* p1, const char* p2, size_t len) {
+  while (len >= 8) {
+    uint64_t mask = *(uint64_t*)p1 ^ *(uint64_t*)p2;
+    if (mask) {
+      int i = __builtin_ctzll(mask) >> 3;
+      return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
+    }
+    p1 += 8;
+    p2 += 8;
+    len -= 8;
+  }
+  for (size_t i = 0; i < len; i++) {
+    int res = (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
+    if (res) return res;
+  }
+  return 0;
+}
+
+// Len <= 16 bytes are loaded by at most two overlapping words: head and tail are both Len if Len is 1/2/4/8,
+// otherwise the head is the widest word not longer than Len and the tail is the word of the same size ending at Len
+template<size_t Len>
+struct SmallWord
+{
+  static_assert(Len >= 1 && Len <= 16, "Len out of range");
+  using T = typename std::conditional<
+    Len >= 8, uint64_t,
+    typename std::conditional<Len >= 4, uint32_t, typename std::conditional<Len >= 2, uint16_t, uint8_t>::type>::type>::
+    type;
+
+  static T load(const char* p) {
+    T v;
+    memcpy(&v, p, sizeof(T));
+    return v;
+  }
+
+  static T bswap(T v) {
+    switch (sizeof(T)) {
+      case 2: return __builtin_bswap16(v);
+      case 4: return __builtin_bswap32(v);
+      case 8: return __builtin_bswap64(v);
+    }
+    return v;
+  }
+
+  static bool eq(const char* p1, const char* p2) {
+    if (Len == sizeof(T)) return load(p1) == load(p2);
+    return ((load(p1) ^ load(p2)) | (load(p1 + Len - sizeof(T)) ^ load(p2 + Len - sizeof(T)))) == 0;
+  }
+
+  // words are byte swapped to big endian so their integer order is the lexicographic order, and if the heads are
+  // equal so are the overlapping bytes of the tails, thus comparing head then tail is correct.
+  // the heads of real keys mostly differ, so the branch is well predicted
+  static int compare(const char* p1, const char* p2) {
+    T h1 = bswap(load(p1)), h2 = bswap(load(p2));
+    if (h1 != h2) return h1 < h2 ? -1 : 1;
+    if (Len == sizeof(T)) return 0;
+    T t1 = bswap(load(p1 + Len - sizeof(T))), t2 = bswap(load(p2 + Len - sizeof(T)));
+    return (t1 > t2) - (t1 < t2);
+  }
+
+  // branch free, for operator<
+  static bool less(const char* p1, const char* p2) {
+    T h1 = bswap(load(p1)), h2 = bswap(load(p2));
+    if (Len == sizeof(T)) return h1 < h2;
+    T t1 = bswap(load(p1 + Len - sizeof(T))), t2 = bswap(load(p2 + Len - sizeof(T)));
+    return (h1 < h2) | ((h1 == h2) & (t1 < t2));
+  }
+};
+
+// kernels of each instruction set below are compiled by target attributes regardless of the compiling options,
+// so that the best one can be chosen at runtime by the running CPU
+
+// for len >= the vector width, the tail shorter than a vector is compared by one more load ending at the last byte,
+// which overlaps the bytes already found equal, so there's no scalar loop for the tail
+
+__attribute__((target("sse2"))) inline uint32_t sse2NEMask(const char* p1, const char* p2) {
+  return ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i*)p1), _mm_loadu_si128((__m128i*)p2))) & 0xffff;
+}
+
+__attribute__((target("sse2"))) inline bool sse2EQ(const char* p1, const char* p2, size_t len) {
+  if (len < 16) return genericEQ(p1, p2, len);
+  const char* e1 = p1 + len - 16;
+  const char* e2 = p2 + len - 16;
+  while (len > 32) {
+    if (sse2NEMask(p1, p2) | sse2NEMask(p1 + 16, p2 + 16)) return false;
+    p1 += 32;
+    p2 += 32;
+    len -= 32;
+  }
+  if (len > 16 && sse2NEMask(p1, p2)) return false;
+  return !sse2NEMask(e1, e2);
+}
+
+__attribute__((target("sse2"))) inline int sse2Compare(const char* p1, const char* p2, size_t len) {
+  if (len < 16) return genericCompare(p1, p2, len);
+  const char* e1 = p1 + len - 16;
+  const char* e2 = p2 + len - 16;
+  while (len > 32) {
+    uint32_t mask = sse2NEMask(p1, p2) | (sse2NEMask(p1 + 16, p2 + 16) << 16);
+    if (mask) {
+      int i = __builtin_ctz(mask);
+      return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
+    }
+    p1 += 32;
+    p2 += 32;
+    len -= 32;
+  }
+  if (len > 16) {
+    uint32_t mask = sse2NEMask(p1, p2);
+    if (mask) {
+      int i = __builtin_ctz(mask);
+      return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
+    }
+  }
+  uint32_t mask = sse2NEMask(e1, e2);
+  if (mask) {
+    int i = __builtin_ctz(mask);
+    return (int)(uint8_t)e1[i] - (int)(uint8_t)e2[i];
+  }
+  return 0;
+}
+
+__attribute__((target("avx2"))) inline uint32_t avx2NEMask(const char* p1, const char* p2) {
+  return ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i*)p1), _mm256_loadu_si256((__m256i*)p2)));
+}
+
+__attribute__((target("avx2"))) inline bool avx2EQ(const char* p1, const char* p2, size_t len) {
+  if (len < 32) return sse2EQ(p1, p2, len);
+  const char* e1 = p1 + len - 32;
+  const char* e2 = p2 + len - 32;
+  while (len > 64) {
+    if (avx2NEMask(p1, p2) | avx2NEMask(p1 + 32, p2 + 32)) return false;
+    p1 += 64;
+    p2 += 64;
+    len -= 64;
+  }
+  if (len > 32 && avx2NEMask(p1, p2)) return false;
+  return !avx2NEMask(e1, e2);
+}
+
+__attribute__((target("avx2"))) inline int avx2Compare(const char* p1, const char* p2, size_t len) {
+  if (len < 32) return sse2Compare(p1, p2, len);
+  const char* e1 = p1 + len - 32;
+  const char* e2 = p2 + len - 32;
+  while (len > 64) {
+    uint64_t mask = avx2NEMask(p1, p2) | ((uint64_t)avx2NEMask(p1 + 32, p2 + 32) << 32);
+    if (mask) {
+      int i = __builtin_ctzll(mask);
+      return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
+    }
+    p1 += 64;
+    p2 += 64;
+    len -= 64;
+  }
+  if (len > 32) {
+    uint32_t mask = avx2NEMask(p1, p2);
+    if (mask) {
+      int i = __builtin_ctz(mask);
+      return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
+    }
+  }
+  uint32_t mask = avx2NEMask(e1, e2);
+  if (mask) {
+    int i = __builtin_ctz(mask);
+    return (int)(uint8_t)e1[i] - (int)(uint8_t)e2[i];
+  }
+  return 0;
+}
+
+// masked loads don't touch the bytes out of the mask, so the last len < 64 bytes are compared by one masked compare
+__attribute__((target("avx512f,avx512bw,avx512vl"))) inline uint64_t avx512NEMask(const char* p1, const char* p2,
+                                                                                   uint64_t k) {
+  return _mm512_cmpneq_epu8_mask(_mm512_maskz_loadu_epi8(k, p1), _mm512_maskz_loadu_epi8(k, p2));
+}
+
+// Len is known at compile time so the mask is a constant, and the narrowest vector holding Len bytes is used
+template<size_t Len>
+__attribute__((target("avx512f,avx512bw,avx512vl"))) inline uint64_t avx512NEMask(const char* p1, const char* p2) {
+  static_assert(Len <= 64, "Len too large");
+  const uint64_t k = Len == 64 ? ~0ull : (1ull << Len) - 1;
+  if (Len <= 16) return _mm_cmpneq_epu8_mask(_mm_maskz_loadu_epi8(k, p1), _mm_maskz_loadu_epi8(k, p2));
+  if (Len <= 32) return _mm256_cmpneq_epu8_mask(_mm256_maskz_loadu_epi8(k, p1), _mm256_maskz_loadu_epi8(k, p2));
+  return avx512NEMask(p1, p2, k);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vl"))) inline bool avx512EQ(const char* p1, const char* p2, size_t len) {
+  while (len >= 64) {
+    uint64_t mask = _mm512_cmpneq_epu8_mask(_mm512_loadu_si512(p1), _mm512_loadu_si512(p2));
+    if (mask) return false;
+    p1 += 64;
+    p2 += 64;
+    len -= 64;
+  }
+  return !len || !avx512NEMask(p1, p2, (1ull << len) - 1);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vl"))) inline int avx512Compare(const char* p1, const char* p2, size_t len) {
+  while (len >= 64) {
+    uint64_t mask = _mm512_cmpneq_epu8_mask(_mm512_loadu_si512(p1), _mm512_loadu_si512(p2));
+    if (mask) {
+      int i = __builtin_ctzll(mask);
+      return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
+    }
+    p1 += 64;
+    p2 += 64;
+    len -= 64;
+  }
+  if (!len) return 0;
+  uint64_t mask = avx512NEMask(p1, p2, (1ull << len) - 1);
+  if (mask) {
+    int i = __builtin_ctzll(mask);
+    return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
+  }
+  return 0;
+}
+
+struct CmpKernel
+{
+  const char* name;
+  bool (*eq)(const char*, const char*, size_t);
+  int (*compare)(const char*, const char*, size_t);
+};
+
+// all kernels from the best to the worst
+static const int CmpKernelCnt = 4;
+inline const CmpKernel& getCmpKernel(int i) {
+  static const CmpKernel kernels[CmpKernelCnt] = {{"avx512", avx512EQ, avx512Compare},
+                                                  {"avx2", avx2EQ, avx2Compare},
+                                                  {"sse2", sse2EQ, sse2Compare},
+                                                  {"generic", genericEQ, genericCompare}};
+  return kernels[i];
+}
+
+inline bool cmpKernelSupported(int i) {
+  __builtin_cpu_init(); // in case it's called before libgcc's own initialization, e.g. in a static constructor
+  switch (i) {
+    case 0: return __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl");
+    case 1: return __builtin_cpu_supports("avx2");
+    case 2: return __builtin_cpu_supports("sse2");
+  }
+  return true;
+}
+
+// the best kernel supported by the running CPU
+inline const CmpKernel& bestCmpKernel() {
+  int i = 0;
+  while (!cmpKernelSupported(i)) i++;
+  return getCmpKernel(i);
+}
+
+// kernel pointers start with the resolvers which bind the best kernel on the first call,
+// so there's no check on later calls and it works even before static initialization
+template<typename T = void>
+struct CmpDispatch
+{
+  using EQFunc = bool (*)(const char*, const char*, size_t);
+  using CompareFunc = int (*)(const char*, const char*, size_t);
+
+  static bool resolveEQ(const char* p1, const char* p2, size_t len) {
+    EQFunc f = bestCmpKernel().eq;
+    eq.store(f, std::memory_order_relaxed);
+    return f(p1, p2, len);
+  }
+
+  static int resolveCompare(const char* p1, const char* p2, size_t len) {
+    CompareFunc f = bestCmpKernel().compare;
+    compare.store(f, std::memory_order_relaxed);
+    return f(p1, p2, len);
+  }
+
+  static std::atomic<EQFunc> eq;
+  static std::atomic<CompareFunc> compare;
+};
+
+template<typename T>
+std::atomic<typename CmpDispatch<T>::EQFunc> CmpDispatch<T>::eq{CmpDispatch<T>::resolveEQ};
+
+template<typename T>
+std::atomic<typename CmpDispatch<T>::CompareFunc> CmpDispatch<T>::compare{CmpDispatch<T>::resolveCompare};
+
+// the 16 bytes starting at 16 - n is a _mm_shuffle_epi8 mask shifting a lane right by n bytes and zeroing the first n
+const char shift_right_tbl[32] = {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                  0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15};
+
+constexpr uint64_t pow10_tbl[20] = {1ull,
+                                   10ull,
+                                   100ull,
+                                   1000ull,
+                                   10000ull,
+                                   100000ull,
+                                   1000000ull,
+                                   10000000ull,
+                                   100000000ull,
+                                   1000000000ull,
+                                   10000000000ull,
+                                   100000000000ull,
+                                   1000000000000ull,
+                                   10000000000000ull,
+                                   100000000000000ull,
+                                   1000000000000000ull,
+                                   10000000000000000ull,
+                                   100000000000000000ull,
+                                   1000000000000000000ull,
+                                   10000000000000000000ull};
+
+// count of decimal digits in num, 0 has 1 digit
+inline uint32_t digitCount(uint64_t num) {
+  num |= 1;
+  // floor(log10(num)) or 1 more, as log10(2) ~= 1233 / 4096
+  uint32_t t = (64 - __builtin_clzll(num)) * 1233 >> 12;
+  return t + 1 - (num < pow10_tbl[t]);
+}
+
+// digits of v < 10^8 in the 8 16-bit lanes from the highest, computed by multiply-shift instead of division.
+// http://0x80.pl/articles/sse-itoa.html
+inline __m128i simdDigits8(uint32_t v) {
+  __m128i x = _mm_cvtsi32_si128(v);
+  // abcdefgh divmod 10000 by multiplying the reciprocal
+  __m128i abcd = _mm_srli_epi64(_mm_mul_epu32(x, _mm_set1_epi32(0xd1b71759)), 45);
+  __m128i efgh = _mm_sub_epi32(x, _mm_mul_epu32(abcd, _mm_set1_epi32(10000)));
+  // abcd * 4 in lane 0~3, efgh * 4 in lane 4~7
+  __m128i v1 = _mm_slli_epi64(_mm_unpacklo_epi16(abcd, efgh), 2);
+  __m128i v2 = _mm_unpacklo_epi16(v1, v1);
+  v2 = _mm_unpacklo_epi32(v2, v2);
+  // [a, ab, abc, abcd, e, ef, efg, efgh] by dividing 10^3, 10^2, 10^1, 10^0
+  __m128i v3 = _mm_mulhi_epu16(v2, _mm_setr_epi16(8389, 5243, 13108, -32768, 8389, 5243, 13108, -32768));
+  __m128i v4 = _mm_mulhi_epu16(v3, _mm_setr_epi16(1 << 7, 1 << 11, 1 << 13, -32768, 1 << 7, 1 << 11, 1 << 13, -32768));
+  // subtract 10 times the lane before
+  __m128i v5 = _mm_mullo_epi16(v4, _mm_set1_epi16(10));
+  return _mm_sub_epi16(v4, _mm_slli_epi64(v5, 16));
+}
+
+// 16 digits of hi * 10^8 + lo(hi, lo < 10^8) in the 16 bytes(not in ascii yet), with AVX2 the 2 halves are computed
+// in the 2 lanes of a ymm register
+inline __m128i simdDigits16(uint32_t hi, uint32_t lo) {
+#ifdef __AVX2__
+  __m128i x = _mm_set_epi64x(lo, hi);
+  __m128i abcd = _mm_srli_epi64(_mm_mul_epu32(x, _mm_set1_epi32(0xd1b71759)), 45);
+  __m128i efgh = _mm_sub_epi32(x, _mm_mul_epu32(abcd, _mm_set1_epi32(10000)));
+  // abcd * 4 and efgh * 4 in 16-bit lane 0 and 1 of each 64-bit lane
+  __m128i v1 = _mm_slli_epi64(_mm_or_si128(abcd, _mm_slli_epi64(efgh, 16)), 2);
+  // hi's in lane 0~7 and lo's in lane 8~15, both as [abcd * 4 x 4, efgh * 4 x 4]
+  __m256i v2 = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(v1),
+                                   _mm256_setr_epi8(0, 1, 0, 1, 0, 1, 0, 1, 2, 3, 2, 3, 2, 3, 2, 3, 8, 9, 8, 9, 8, 9, 8,
+                                                    9, 10, 11, 10, 11, 10, 11, 10, 11));
+  __m256i v3 = _mm256_mulhi_epu16(v2, _mm256_setr_epi16(8389, 5243, 13108, -32768, 8389, 5243, 13108, -32768, 8389,
+                                                        5243, 13108, -32768, 8389, 5243, 13108, -32768));
+  __m256i v4 = _mm256_mulhi_epu16(v3, _mm256_setr_epi16(1 << 7, 1 << 11, 1 << 13, -32768, 1 << 7, 1 << 11, 1 << 13,
+                                                        -32768, 1 << 7, 1 << 11, 1 << 13, -32768, 1 << 7, 1 << 11,
+                                                        1 << 13, -32768));
+  __m256i v5 = _mm256_mullo_epi16(v4, _mm256_set1_epi16(10));
+  __m256i v6 = _mm256_sub_epi16(v4, _mm256_slli_epi64(v5, 16));
+  // the low 8 bytes of each lane
+  __m256i v7 = _mm256_permute4x64_epi64(_mm256_packus_epi16(v6, v6), 0x8);
+  return _mm256_castsi256_si128(v7);
+#else
+  return _mm_packus_epi16(simdDigits8(hi), simdDigits8(lo));
+#endif
+}
+
+#if defined(__AVX512VL__) && defined(__AVX512BW__)
+// 32 digits of the 4 numbers(< 10^8 each) in the 32-bit lanes of v in the 32 bytes(not in ascii yet), 8 bytes for each,
+// same as simdDigits8 but the 4 numbers are computed in the 4 lanes of a zmm register
+inline __m256i simdDigits32(__m128i v) {
+  __m256i x = _mm256_cvtepu32_epi64(v);
+  __m256i abcd = _mm256_srli_epi64(_mm256_mul_epu32(x, _mm256_set1_epi32(0xd1b71759)), 45);
+  __m256i efgh = _mm256_sub_epi32(x, _mm256_mul_epu32(abcd, _mm256_set1_epi32(10000)));
+  // abcd * 4 and efgh * 4 in 16-bit lane 0 and 1 of each 64-bit lane
+  __m256i y = _mm256_slli_epi64(_mm256_or_si256(abcd, _mm256_slli_epi64(efgh, 16)), 2);
+  // lane k of 128 bits takes [abcd * 4 x 4, efgh * 4 x 4] of the kth number
+  __m512i z = _mm512_permutexvar_epi64(_mm512_setr_epi64(0, 0, 1, 1, 2, 2, 3, 3), _mm512_castsi256_si512(y));
+  z = _mm512_shuffle_epi8(z, _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 0, 1, 0, 1, 0, 1, 2, 3, 2, 3, 2, 3, 2, 3)));
+  z = _mm512_mulhi_epu16(
+    z, _mm512_broadcast_i32x4(_mm_setr_epi16(8389, 5243, 13108, -32768, 8389, 5243, 13108, -32768)));
+  z = _mm512_mulhi_epu16(
+    z, _mm512_broadcast_i32x4(_mm_setr_epi16(1 << 7, 1 << 11, 1 << 13, -32768, 1 << 7, 1 << 11, 1 << 13, -32768)));
+  z = _mm512_sub_epi16(z, _mm512_slli_epi64(_mm512_mullo_epi16(z, _mm512_set1_epi16(10)), 16));
+  // the low 8 bytes of each lane
+  z = _mm512_permutexvar_epi64(_mm512_setr_epi64(0, 2, 4, 6, 0, 2, 4, 6), _mm512_packus_epi16(z, z));
+  return _mm512_castsi512_si256(z);
+}
+#endif
+
+#ifdef __AVX2__
+// 16 bytes from p and p + stride in the 2 lanes
+inline __m256i loadLanes(const char* p, size_t stride) {
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((__m128i*)p)),
+                                 _mm_loadu_si128((__m128i*)(p + stride)), 1);
+}
+#endif
+
+#ifdef __AVX512BW__
+// 16 bytes from p, p + stride, p + stride * 2 and p + stride * 3 in the 4 lanes
+inline __m512i loadLanes4(const char* p, size_t stride) {
+  return _mm512_inserti64x4(_mm512_castsi256_si512(loadLanes(p, stride)), loadLanes(p + stride * 2, stride), 1);
+}
+#endif
+
+} // namespace str_detail
+
+// how a number is padded in a fixed width field
+enum StrPad : uint32_t
+{
+  PadZero,    // right justified with leading zeros, e.g. "00123"
+  PadSpace,   // right justified with leading spaces, e.g. "  123"
+  PadTrailing // left justified with trailing spaces, e.g. "123  "
+};
+
 template<size_t SIZE>
 class Str
 {
@@ -37,6 +471,10 @@ public:
   // Str is not required to align with AlignSize, in order to provide flexibility as a pure char array wrapper
   // but aligning Str could speed up comparison operations
   static const int AlignSize = SIZE >= 7 ? 8 : 4;
+  // if compiled without AVX2, comparisons of Str not shorter than DispatchSize call the kernel chosen by the
+  // running CPU through a function pointer, otherwise the inlined simd kernel of the compiling target is used for
+  // Str not shorter than 16 bytes. define STR_NO_RUNTIME_DISPATCH to always use the inlined code
+  static const int DispatchSize = 32;
   char s[SIZE];
 
   Str() {}
@@ -46,9 +484,15 @@ public:
   char operator[](int i) const { return s[i]; }
 
   bool operator==(const char* p2) const {
+    if (SIZE <= 16) return str_detail::SmallWord<SIZE <= 16 ? SIZE : 16>::eq(s, p2);
 #if defined(__AVX512VL__) && defined(__AVX512BW__)
+    if (SIZE <= 64) return !str_detail::avx512NEMask<SIZE <= 64 ? SIZE : 64>(s, p2);
     return simdEQ(s, p2, SIZE);
 #else
+#if !defined(__AVX2__) && !defined(STR_NO_RUNTIME_DISPATCH)
+    if (SIZE >= DispatchSize) return str_detail::CmpDispatch<>::eq.load(std::memory_order_relaxed)(s, p2, SIZE);
+#endif
+    if (SIZE >= 16) return simdEQ(s, p2, SIZE);
     return genericEQ(s, p2, SIZE);
 #endif
   }
@@ -57,54 +501,35 @@ public:
   bool operator!=(const char* p) const { return !operator==(p); }
   bool operator!=(const Str<SIZE>& rhs) const { return !operator==(rhs.s); }
 
-  static bool genericEQ(const char* p1, const char* p2, size_t len) {
-    while (len >= 8) {
-      if (*(uint64_t*)p1 != *(uint64_t*)p2) return false;
-      p1 += 8;
-      p2 += 8;
-      len -= 8;
-    }
-    if (len >= 4) {
-      if (*(uint32_t*)(p1) != *(uint32_t*)(p2)) return false;
-      p1 += 4;
-      p2 += 4;
-      len -= 4;
-    }
-    switch (len) {
-      case 1: return *p1 == *p2;
-      case 2: return *(uint16_t*)p1 == *(uint16_t*)p2;
-      case 3: return *(uint16_t*)p1 == *(uint16_t*)p2 && p1[2] == p2[2];
-    };
-    return true;
-  }
+  static bool genericEQ(const char* p1, const char* p2, size_t len) { return str_detail::genericEQ(p1, p2, len); }
 
   int compare(const char* p2) const {
+    if (SIZE <= 16) return str_detail::SmallWord<SIZE <= 16 ? SIZE : 16>::compare(s, p2);
 #if defined(__AVX512VL__) && defined(__AVX512BW__)
+    if (SIZE <= 64) {
+      uint64_t mask = str_detail::avx512NEMask<SIZE <= 64 ? SIZE : 64>(s, p2);
+      if (!mask) return 0;
+      int i = __builtin_ctzll(mask);
+      return (int)(uint8_t)s[i] - (int)(uint8_t)p2[i];
+    }
     return simdCompare(s, p2, SIZE);
 #else
+#if !defined(__AVX2__) && !defined(STR_NO_RUNTIME_DISPATCH)
+    if (SIZE >= DispatchSize) return str_detail::CmpDispatch<>::compare.load(std::memory_order_relaxed)(s, p2, SIZE);
+#endif
+    if (SIZE >= 16) return simdCompare(s, p2, SIZE);
     return genericCompare(s, p2, SIZE);
 #endif
   }
   int compare(const Str<SIZE>& rhs) const { return compare(rhs.s); }
-  bool operator<(const char* p2) const { return compare(p2) < 0; }
-  bool operator<(const Str<SIZE>& rhs) const { return compare(rhs.s) < 0; }
+  bool operator<(const char* p2) const {
+    if (SIZE <= 16) return str_detail::SmallWord<SIZE <= 16 ? SIZE : 16>::less(s, p2);
+    return compare(p2) < 0;
+  }
+  bool operator<(const Str<SIZE>& rhs) const { return operator<(rhs.s); }
 
   static int genericCompare(const char* p1, const char* p2, size_t len) {
-    while (len >= 8) {
-      uint64_t mask = *(uint64_t*)p1 ^ *(uint64_t*)p2;
-      if (mask) {
-        int i = __builtin_ctzll(mask) >> 3;
-        return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
-      }
-      p1 += 8;
-      p2 += 8;
-      len -= 8;
-    }
-    for (size_t i = 0; i < len; i++) {
-      int res = (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
-      if (res) return res;
-    }
-    return 0;
+    return str_detail::genericCompare(p1, p2, len);
   }
 
 #if __cplusplus >= 201703L
@@ -112,68 +537,22 @@ public:
 #endif
 
 #if defined(__AVX512VL__) && defined(__AVX512BW__)
-  static bool simdEQ(const char* p1, const char* p2, size_t len) {
-    while (len >= 64) {
-      uint64_t mask = _mm512_cmpneq_epu8_mask(_mm512_loadu_si512(p1), _mm512_loadu_si512(p2));
-      if (mask) return false;
-      p1 += 64;
-      p2 += 64;
-      len -= 64;
-    }
-
-    if (len >= 32) {
-      uint32_t mask = _mm256_cmpneq_epu8_mask(_mm256_loadu_si256((__m256i*)p1), _mm256_loadu_si256((__m256i*)p2));
-      if (mask) return false;
-      p1 += 32;
-      p2 += 32;
-      len -= 32;
-    }
-    if (len >= 16) {
-      uint16_t mask = _mm_cmpneq_epu8_mask(_mm_loadu_si128((__m128i*)p1), _mm_loadu_si128((__m128i*)p2));
-      if (mask) return false;
-      p1 += 16;
-      p2 += 16;
-      len -= 16;
-    }
-    return genericEQ(p1, p2, len);
-  }
-
-  static int simdCompare(const char* p1, const char* p2, size_t len) {
-    while (len >= 64) {
-      uint64_t mask = _mm512_cmpneq_epu8_mask(_mm512_loadu_si512(p1), _mm512_loadu_si512(p2));
-      if (mask) {
-        int i = __builtin_ctzll(mask);
-        return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
-      }
-      p1 += 64;
-      p2 += 64;
-      len -= 64;
-    }
-    if (len >= 32) {
-      uint32_t mask = _mm256_cmpneq_epu8_mask(_mm256_loadu_si256((__m256i*)p1), _mm256_loadu_si256((__m256i*)p2));
-      if (mask) {
-        int i = __builtin_ctz(mask);
-        return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
-      }
-      p1 += 32;
-      p2 += 32;
-      len -= 32;
-    }
-    if (len >= 16) {
-      uint16_t mask = _mm_cmpneq_epu8_mask(_mm_loadu_si128((__m128i*)p1), _mm_loadu_si128((__m128i*)p2));
-      if (mask) {
-        int i = __builtin_ctz(mask);
-        return (int)(uint8_t)p1[i] - (int)(uint8_t)p2[i];
-      }
-      p1 += 16;
-      p2 += 16;
-      len -= 16;
-    }
-    return genericCompare(p1, p2, len);
-  }
+  static bool simdEQ(const char* p1, const char* p2, size_t len) { return str_detail::avx512EQ(p1, p2, len); }
+
+  static int simdCompare(const char* p1, const char* p2, size_t len) { return str_detail::avx512Compare(p1, p2, len); }
+#elif defined(__AVX2__)
+  static bool simdEQ(const char* p1, const char* p2, size_t len) { return str_detail::avx2EQ(p1, p2, len); }
+
+  static int simdCompare(const char* p1, const char* p2, size_t len) { return str_detail::avx2Compare(p1, p2, len); }
+#else
+  static bool simdEQ(const char* p1, const char* p2, size_t len) { return str_detail::sse2EQ(p1, p2, len); }
+
+  static int simdCompare(const char* p1, const char* p2, size_t len) { return str_detail::sse2Compare(p1, p2, len); }
 #endif
 
+  template<StrPad Pad = PadZero>
   uint32_t toi() const {
+    if (Pad != PadZero) return padtoi64<Pad>();
     uint32_t ret = 0;
     switch (SIZE) {
       case 10: ret += (s[SIZE - 10] - '0') * 1000000000;
@@ -194,9 +573,14 @@ public:
     return ret;
   }
 
+  template<StrPad Pad = PadZero>
   uint64_t toi64() const {
+    static_assert(SIZE <= 20, "too many digits for uint64");
+    if (Pad != PadZero) return padtoi64<Pad>();
     uint64_t ret = 0;
     switch (SIZE) {
+      // a 20 digit number above UINT64_MAX wraps around, use the checked version to detect it
+      case 20: ret += (s[SIZE - 20] - '0') * 10000000000000000000ULL;
       case 19: ret += (s[SIZE - 19] - '0') * 1000000000000000000LL;
       case 18: ret += (s[SIZE - 18] - '0') * 100000000000000000LL;
       case 17: ret += (s[SIZE - 17] - '0') * 10000000000000000LL;
@@ -228,16 +612,239 @@ public:
     return ret;
   }
 
+  // same as toi and toi64, but validate that all chars are digits in the same pass, return false if not.
+  // a number above UINT32_MAX is taken as invalid for toi
+  bool toi(uint32_t& num) const {
+    uint64_t ret;
+    bool ok = toi64(ret);
+    num = ret;
+    return ok && (SIZE <= 9 || ret <= UINT32_MAX);
+  }
+
+  // a 20 digit number above UINT64_MAX is taken as invalid
+  bool toi64(uint64_t& num) const {
+    static_assert(SIZE <= 20, "too many digits for uint64");
+    uint32_t bad = 0;
+#ifdef __SSE4_1__
+    if (SIZE >= 5 && SIZE <= 16) {
+      // the whole field is validated in one lane, then shifted to the end of the lane.
+      // fewer digits are faster by scalar code
+      __m128i in = _mm_sub_epi8(_mm_loadu_si128((__m128i*)s), _mm_set1_epi8('0'));
+      bad = simdNonDigitMask(in) & ((1u << (SIZE & 31)) - 1);
+      in = _mm_shuffle_epi8(in, _mm_loadu_si128((__m128i*)(str_detail::shift_right_tbl + (SIZE <= 16 ? SIZE : 16))));
+      num = simdtoi64(in);
+      return !bad;
+    }
+    const bool SimdLow = SIZE > 16;
+#else
+    const bool SimdLow = false;
+#endif
+    // the digits above the lowest 16 are parsed as hi and folded at the end, which is where a 20 digit number overflows
+    const size_t LowSize = SIZE > 16 ? 16 : SIZE;
+    uint64_t hi = 0, lo = 0;
+    for (size_t i = 0; i < SIZE - LowSize; i++) {
+      uint8_t d = s[i] - '0';
+      bad |= d > 9;
+      hi += d * str_detail::pow10_tbl[SIZE - LowSize - 1 - i];
+    }
+#ifdef __SSE4_1__
+    if (SimdLow) lo = simdtoi64(s + SIZE - 16, bad);
+#endif
+    for (size_t i = SimdLow ? SIZE : SIZE - LowSize; i < SIZE; i++) {
+      uint8_t d = s[i] - '0';
+      bad |= d > 9;
+      lo += d * str_detail::pow10_tbl[SIZE - 1 - i];
+    }
+    if (SIZE < 20) {
+      num = hi * 10000000000000000LL + lo;
+      return !bad;
+    }
+    bool overflow = __builtin_mul_overflow(hi, 10000000000000000ULL, &num);
+    overflow |= __builtin_add_overflow(num, lo, &num);
+    return !bad && !overflow;
+  }
+
+  // signed number with the sign in the first char of the field followed by SIZE - 1 digits, e.g. -000123 or +000123,
+  // any char other than '-' is taken as positive
+  int32_t tosi() const {
+    static_assert(SIZE >= 2, "no room for digits");
+    static_assert(SIZE - 1 <= 10, "too many digits for int32, use tosi64");
+    int32_t ret = ((const Str<SIZE - 1>*)(s + 1))->toi();
+    int32_t neg = -(int32_t)(s[0] == '-');
+    return (ret ^ neg) - neg;
+  }
+
+  int64_t tosi64() const {
+    static_assert(SIZE >= 2, "no room for digits");
+    static_assert(SIZE - 1 <= 19, "too many digits for int64");
+    int64_t ret = ((const Str<SIZE - 1>*)(s + 1))->toi64();
+    int64_t neg = -(int64_t)(s[0] == '-');
+    return (ret ^ neg) - neg;
+  }
+
+  // toi64 of n fields at p, p + stride, p + stride * 2... into out, e.g. a Str<SIZE> array(stride = SIZE) or a field in
+  // an array of fixed layout records(stride = record size). with AVX2(AVX512BW) the lowest 16 digits of 4(8) fields
+  // are converted by one pass, 16 bytes are loaded from each field as toi64 does
+  static void toi64Batch(const char* p, size_t stride, uint64_t* out, size_t n) {
+    size_t i = 0;
+#ifdef __AVX2__
+    // 16 bytes ending at the last digit for SIZE >= 16, otherwise loaded from the field and shifted to the lane end
+    const size_t Offset = SIZE > 16 ? SIZE - 16 : 0;
+    const size_t HeadSize = SIZE > 16 ? SIZE - 16 : 1;
+#ifdef __AVX512BW__
+    {
+      __m512i ascii0 = _mm512_set1_epi8('0');
+      __m512i shift =
+        _mm512_broadcast_i32x4(_mm_loadu_si128((__m128i*)(str_detail::shift_right_tbl + (SIZE < 16 ? SIZE : 16))));
+      __m512i mul_1_10 = _mm512_set1_epi16(0x010a);
+      __m512i mul_1_100 = _mm512_set1_epi32(0x00010064);
+      __m512i mul_1_10000 = _mm512_set1_epi32(0x00012710);
+      for (; i + 8 <= n; i += 8) {
+        const char* f = p + i * stride + Offset;
+        // even fields in a and odd ones in b, so the results are in order after a and b are packed into one register
+        __m512i a = _mm512_sub_epi8(str_detail::loadLanes4(f, stride * 2), ascii0);
+        __m512i b = _mm512_sub_epi8(str_detail::loadLanes4(f + stride, stride * 2), ascii0);
+        if (SIZE < 16) {
+          a = _mm512_shuffle_epi8(a, shift);
+          b = _mm512_shuffle_epi8(b, shift);
+        }
+        __m512i ta = _mm512_madd_epi16(_mm512_maddubs_epi16(a, mul_1_10), mul_1_100);
+        __m512i tb = _mm512_madd_epi16(_mm512_maddubs_epi16(b, mul_1_10), mul_1_100);
+        __m512i t = _mm512_madd_epi16(_mm512_packus_epi32(ta, tb), mul_1_10000);
+        // high 8 digits in the low 32 bits of each 64-bit lane
+        t = _mm512_add_epi64(_mm512_mul_epu32(t, _mm512_set1_epi64(100000000)), _mm512_srli_epi64(t, 32));
+        _mm512_storeu_si512((__m512i*)(out + i), t);
+        if (SIZE > 16) {
+          for (size_t j = i; j < i + 8; j++) {
+            out[j] += ((const Str<HeadSize>*)(p + j * stride))->toi64() * 10000000000000000ULL;
+          }
+        }
+      }
+    }
+#endif
+    __m256i ascii0 = _mm256_set1_epi8('0');
+    __m256i shift =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i*)(str_detail::shift_right_tbl + (SIZE < 16 ? SIZE : 16))));
+    __m256i mul_1_10 = _mm256_set1_epi16(0x010a);
+    __m256i mul_1_100 = _mm256_set1_epi32(0x00010064);
+    __m256i mul_1_10000 = _mm256_set1_epi32(0x00012710);
+    for (; i + 4 <= n; i += 4) {
+      const char* f = p + i * stride + Offset;
+      __m256i a = _mm256_sub_epi8(str_detail::loadLanes(f, stride * 2), ascii0);
+      __m256i b = _mm256_sub_epi8(str_detail::loadLanes(f + stride, stride * 2), ascii0);
+      if (SIZE < 16) {
+        a = _mm256_shuffle_epi8(a, shift);
+        b = _mm256_shuffle_epi8(b, shift);
+      }
+      __m256i ta = _mm256_madd_epi16(_mm256_maddubs_epi16(a, mul_1_10), mul_1_100);
+      __m256i tb = _mm256_madd_epi16(_mm256_maddubs_epi16(b, mul_1_10), mul_1_100);
+      __m256i t = _mm256_madd_epi16(_mm256_packus_epi32(ta, tb), mul_1_10000);
+      t = _mm256_add_epi64(_mm256_mul_epu32(t, _mm256_set1_epi64x(100000000)), _mm256_srli_epi64(t, 32));
+      _mm256_storeu_si256((__m256i*)(out + i), t);
+      if (SIZE > 16) {
+        for (size_t j = i; j < i + 4; j++) {
+          out[j] += ((const Str<HeadSize>*)(p + j * stride))->toi64() * 10000000000000000ULL;
+        }
+      }
+    }
+#endif
+    for (; i < n; i++) out[i] = ((const Str*)(p + i * stride))->toi64();
+  }
+
+  static void toi64Batch(const Str* strs, uint64_t* out, size_t n) { toi64Batch(strs->s, SIZE, out, n); }
+
+  // spaces are taken as 0, and for PadTrailing the field is right justified by the count of trailing spaces before
+  // the digits are combined. with SSE4.1 a field of up to 16 chars is done in one simd pass without branches
+  template<StrPad Pad>
+  uint64_t padtoi64() const {
+#ifdef __SSE4_1__
+    if (SIZE <= 16) {
+      __m128i in = _mm_loadu_si128((__m128i*)s);
+      uint32_t shift = 16 - SIZE;
+      if (Pad == PadTrailing) {
+        uint32_t field_mask = (1u << (SIZE <= 16 ? SIZE : 16)) - 1;
+        uint32_t digit_mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(in, _mm_set1_epi8(' '))) & field_mask;
+        // if all are spaces the last one is kept, which is parsed as 0
+        shift += SIZE - (32 - __builtin_clz(digit_mask | 1));
+      }
+      // shift the chars to the end of the lane, shifted in lanes become 0
+      in = _mm_shuffle_epi8(in, _mm_loadu_si128((__m128i*)(str_detail::shift_right_tbl + 16 - shift)));
+      return simdtoi64(_mm_subs_epu8(in, _mm_set1_epi8('0')));
+    }
+    if (Pad == PadSpace) {
+      uint64_t ret = 0;
+      for (size_t i = 0; i < SIZE - 16; i++) ret = ret * 10 + (s[i] == ' ' ? 0 : s[i] - '0');
+      __m128i in = _mm_subs_epu8(_mm_loadu_si128((__m128i*)(s + SIZE - 16)), _mm_set1_epi8('0'));
+      return ret * 10000000000000000LL + simdtoi64(in);
+    }
+#endif
+    uint64_t ret = 0;
+    for (size_t i = 0; i < SIZE; i++) {
+      if (s[i] != ' ') ret = ret * 10 + (s[i] - '0');
+    }
+    return ret;
+  }
+
+  // fixed point decimal as an integer scaled by 10^Decimals, e.g. "0001234.50".tofix<2>() is 123450.
+  // the point is at SIZE - 1 - Decimals, or searched in the field if DetectPoint, in which case the number of decimals
+  // could vary(or there's no point) and those more than Decimals are truncated. spaces are taken as zeros.
+  // with SSE4.1 a field of up to 16 chars is parsed in one simd pass, where the point is squeezed out by a shuffle
+  template<uint32_t Decimals, bool DetectPoint = false>
+  uint64_t tofix() const {
+    static_assert(Decimals < SIZE, "no room for the point");
+#ifdef __SSE4_1__
+    if (SIZE <= 16) {
+      __m128i in = _mm_loadu_si128((__m128i*)s);
+      int p = SIZE - 1 - Decimals; // position of the point
+      if (DetectPoint) p = __builtin_ctz(_mm_movemask_epi8(_mm_cmpeq_epi8(in, _mm_set1_epi8('.'))) | (1u << (SIZE & 31)));
+      int dec = std::min(std::max((int)SIZE - 1 - p, 0), (int)Decimals); // decimals to parse
+      int n = p + dec;                                                    // digits to parse
+      // lane i takes the (i - (16 - n))th digit, which is after the point if it's not less than p
+      __m128i iota = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+      __m128i k = _mm_sub_epi8(iota, _mm_set1_epi8(16 - n));
+      __m128i idx = _mm_sub_epi8(k, _mm_cmpgt_epi8(k, _mm_set1_epi8(p - 1)));
+      idx = _mm_or_si128(idx, _mm_cmpgt_epi8(_mm_setzero_si128(), k));
+      in = _mm_shuffle_epi8(in, idx);
+      return simdtoi64(_mm_subs_epu8(in, _mm_set1_epi8('0'))) * str_detail::pow10_tbl[Decimals - dec];
+    }
+#endif
+    if (!DetectPoint) {
+      // the integer part and decimals parsed separately
+      const size_t IntSize = SIZE - 1 - Decimals;
+      uint64_t ret = IntSize ? ((const Str<IntSize ? IntSize : 1>*)s)->template toi64<PadSpace>() : 0;
+      if (Decimals) {
+        ret = ret * str_detail::pow10_tbl[Decimals] + ((const Str<Decimals ? Decimals : 1>*)(s + IntSize + 1))->toi64();
+      }
+      return ret;
+    }
+    uint64_t ret = 0;
+    int dec = -1; // decimals parsed, -1 before the point
+    for (size_t i = 0; i < SIZE; i++) {
+      if (s[i] == '.') {
+        dec = 0;
+        continue;
+      }
+      if (dec == (int)Decimals) break;
+      ret = ret * 10 + (s[i] == ' ' ? 0 : s[i] - '0');
+      if (dec >= 0) dec++;
+    }
+    return ret * str_detail::pow10_tbl[Decimals - std::max(dec, 0)];
+  }
+
 #ifdef __SSE4_1__
   // covert 8 digits into int
   // https://arxiv.org/pdf/1902.08318.pdf, Fig.7
   static uint32_t simdtoi(const char* p) {
     __m128i ascii0 = _mm_set1_epi8('0');
+    // we should've used _mm_loadu_si64 here, but seems _mm_loadu_si128 is faster
+    return simdtoi(_mm_sub_epi8(_mm_loadu_si128((__m128i*)p), ascii0));
+  }
+
+  // covert 8 digit values(0 ~ 9 in each byte) into int
+  static uint32_t simdtoi(__m128i in) {
     __m128i mul_1_10 = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
     __m128i mul_1_100 = _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1);
     __m128i mul_1_10000 = _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1);
-    // we should've used _mm_loadu_si64 here, but seems _mm_loadu_si128 is faster
-    __m128i in = _mm_sub_epi8(_mm_loadu_si128((__m128i*)p), ascii0);
     __m128i t1 = _mm_maddubs_epi16(in, mul_1_10);
     __m128i t2 = _mm_madd_epi16(t1, mul_1_100);
     __m128i t3 = _mm_packus_epi32(t2, t2);
@@ -248,10 +855,14 @@ public:
   // covert 16 digits into int64
   static uint64_t simdtoi64(const char* p) {
     __m128i ascii0 = _mm_set1_epi8('0');
+    return simdtoi64(_mm_sub_epi8(_mm_loadu_si128((__m128i*)p), ascii0));
+  }
+
+  // covert 16 digit values(0 ~ 9 in each byte) into int64
+  static uint64_t simdtoi64(__m128i in) {
     __m128i mul_1_10 = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
     __m128i mul_1_100 = _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1);
     __m128i mul_1_10000 = _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1);
-    __m128i in = _mm_sub_epi8(_mm_loadu_si128((__m128i*)p), ascii0);
     __m128i t1 = _mm_maddubs_epi16(in, mul_1_10);
     __m128i t2 = _mm_madd_epi16(t1, mul_1_100);
     __m128i t3 = _mm_packus_epi32(t2, t2);
@@ -260,15 +871,96 @@ public:
     uint64_t t5 = _mm_cvtsi128_si64(t4);
     return (t5 >> 32) + (t5 & 0xffffffff) * 100000000LL;
   }
+
+  // mask of the lanes whose values(char - '0') are not digits
+  static uint32_t simdNonDigitMask(__m128i in) {
+    return ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(in, _mm_set1_epi8(9)), in));
+  }
+
+  // same as simdtoi and simdtoi64, but also set bad if any char is not a digit
+  static uint32_t simdtoi(const char* p, uint32_t& bad) {
+    __m128i in = _mm_sub_epi8(_mm_loadu_si128((__m128i*)p), _mm_set1_epi8('0'));
+    bad |= simdNonDigitMask(in) & 0xff;
+    return simdtoi(in);
+  }
+
+  static uint64_t simdtoi64(const char* p, uint32_t& bad) {
+    __m128i in = _mm_sub_epi8(_mm_loadu_si128((__m128i*)p), _mm_set1_epi8('0'));
+    bad |= simdNonDigitMask(in) & 0xffff;
+    return simdtoi64(in);
+  }
 #endif
 
-  template<typename T>
+  template<StrPad Pad = PadZero, typename T>
   void fromi(T num) {
+    if (Pad == PadZero) {
+      zerofromi(num);
+      return;
+    }
+    // count of leading zeros to replace, the last digit is always kept
+    int n = std::max((int)SIZE - (int)str_detail::digitCount(num), 0);
+    if (Pad == PadSpace) {
+      zerofromi(num);
+      memset(s, ' ', n);
+    }
+    else {
+      Str<SIZE> tmp;
+      tmp.zerofromi(num);
+      memcpy(s, tmp.s + n, SIZE - n);
+      memset(s + SIZE - n, ' ', n);
+    }
+  }
+
+  // num scaled by 10^Decimals written as a fixed point decimal with zero padded integer part, the inverse of tofix
+  template<uint32_t Decimals>
+  void fromfix(uint64_t num) {
+    static_assert(Decimals >= 1 && Decimals + 2 <= SIZE, "no room for the integer part");
+    ((Str<SIZE - 1 - Decimals>*)s)->fromi(num / str_detail::pow10_tbl[Decimals]);
+    s[SIZE - 1 - Decimals] = '.';
+    ((Str<Decimals>*)(s + SIZE - Decimals))->fromi(num % str_detail::pow10_tbl[Decimals]);
+  }
+
+  // same as fromi<PadZero> but digits are computed 8 at a time in simd registers and written by a single store, it has
+  // a higher throughput than fromi for 16+ digits but a longer latency if the result is read back right away
+  void simdfromi(uint64_t num) {
+    if (SIZE <= 8) {
+      __m128i d = _mm_packus_epi16(str_detail::simdDigits8(num % 100000000), _mm_setzero_si128());
+      d = _mm_srli_si128(_mm_add_epi8(d, _mm_set1_epi8('0')), SIZE <= 8 ? 8 - SIZE : 0);
+      if (SIZE == 8)
+        _mm_storel_epi64((__m128i*)s, d);
+      else
+        simdStore(d);
+      return;
+    }
+    __m128i d = str_detail::simdDigits16(num / 100000000 % 100000000, num % 100000000);
+    d = _mm_add_epi8(d, _mm_set1_epi8('0'));
+    if (SIZE >= 16) {
+      _mm_storeu_si128((__m128i*)(s + SIZE - 16), d);
+      if (SIZE > 16) ((Str<(SIZE > 16 ? SIZE - 16 : 1)>*)s)->zerofromi(num / 10000000000000000LL);
+      return;
+    }
+    simdStore(_mm_srli_si128(d, SIZE < 16 ? 16 - SIZE : 0));
+  }
+
+  // write the first SIZE(< 16) bytes of d
+  void simdStore(__m128i d) {
+#if defined(__AVX512VL__) && defined(__AVX512BW__)
+    _mm_mask_storeu_epi8(s, (1u << (SIZE & 15)) - 1, d);
+#else
+    char tmp[16];
+    _mm_storeu_si128((__m128i*)tmp, d);
+    memcpy(s, tmp, SIZE < 16 ? SIZE : 16);
+#endif
+  }
+
+  template<typename T>
+  void zerofromi(T num) {
     if (Size & 1) {
       s[Size - 1] = '0' + (num % 10);
       num /= 10;
     }
     switch (Size & -2) {
+      case 20: *(uint16_t*)(s + 18) = *(uint16_t*)(digit_pairs + ((num % 100) << 1)); num /= 100;
       case 18: *(uint16_t*)(s + 16) = *(uint16_t*)(digit_pairs + ((num % 100) << 1)); num /= 100;
       case 16: *(uint16_t*)(s + 14) = *(uint16_t*)(digit_pairs + ((num % 100) << 1)); num /= 100;
       case 14: *(uint16_t*)(s + 12) = *(uint16_t*)(digit_pairs + ((num % 100) << 1)); num /= 100;
@@ -281,6 +973,15 @@ public:
     }
   }
 
+  // the sign is written in the first char('-' or pos_sign) followed by SIZE - 1 zero padded digits
+  template<typename T>
+  void fromsi(T num, char pos_sign = '+') {
+    static_assert(SIZE >= 2, "no room for digits");
+    using U = typename std::make_unsigned<T>::type;
+    s[0] = num < 0 ? '-' : pos_sign;
+    ((Str<SIZE - 1>*)(s + 1))->fromi(num < 0 ? U(0) - U(num) : U(num));
+  }
+
   static constexpr const char* digit_pairs = "00010203040506070809"
                                              "10111213141516171819"
                                              "20212223242526272829"
@@ -299,3 +1000,113 @@ std::ostream& operator<<(std::ostream& os, const Str<SIZE>& str) {
   return os;
 }
 
+// a zero padded numeric field of width(1 ~ 20) chars at offset in a message buffer
+struct StrField
+{
+  uint32_t offset;
+  uint32_t width;
+};
+
+// the numeric fields of a message layout, which are planned once so that fromi of all the fields has no per field
+// dispatch on the width. With AVX512BW the fields are packed into groups of 4 chunks of 8 digits ahead of time, the
+// digits of a group are computed together in one zmm register by multiply-shift and each field is written by a masked
+// store. Otherwise generating digits 2 chunks at a time and the variable width stores cost more than per field fromi,
+// so each field is written by Str<width>::fromi through a function pointer got at planning
+template<size_t N>
+class StrFields
+{
+public:
+  explicit StrFields(const StrField* fields) {
+#if defined(__AVX512VL__) && defined(__AVX512BW__)
+    // first fit of the fields with the most chunks first
+    for (uint32_t chunks = 3; chunks >= 1; chunks--) {
+      for (uint32_t i = 0; i < N; i++) {
+        if ((fields[i].width + 7) / 8 == chunks) addField(i, fields[i].offset, fields[i].width, chunks);
+      }
+    }
+#else
+    static void (*const fromi_tbl[])(char*, uint64_t) = {
+      &fromiW<1>,  &fromiW<2>,  &fromiW<3>,  &fromiW<4>,  &fromiW<5>,  &fromiW<6>,  &fromiW<7>,
+      &fromiW<8>,  &fromiW<9>,  &fromiW<10>, &fromiW<11>, &fromiW<12>, &fromiW<13>, &fromiW<14>,
+      &fromiW<15>, &fromiW<16>, &fromiW<17>, &fromiW<18>, &fromiW<19>, &fromiW<20>};
+    for (uint32_t i = 0; i < N; i++) {
+      offsets[i] = fields[i].offset;
+      fns[i] = fromi_tbl[fields[i].width - 1];
+    }
+#endif
+  }
+
+  // same as Str<fields[i].width>::fromi(nums[i]) at buf + fields[i].offset for each field
+  void fromi(char* buf, const uint64_t* nums) const {
+#if defined(__AVX512VL__) && defined(__AVX512BW__)
+    __m256i ascii0 = _mm256_set1_epi8('0');
+    for (uint32_t g = 0; g < n_groups; g++) {
+      const Group& grp = groups[g];
+      __m128i c = _mm_setr_epi32(chunk(nums[grp.idx[0]], grp.kind[0]), chunk(nums[grp.idx[1]], grp.kind[1]),
+                                 chunk(nums[grp.idx[2]], grp.kind[2]), chunk(nums[grp.idx[3]], grp.kind[3]));
+      __m256i d = _mm256_add_epi8(str_detail::simdDigits32(c), ascii0);
+      // lanes masked off are not accessed, so it's fine that the store starts before the field
+      for (uint32_t k = 0; k < grp.n_slots; k++) _mm256_mask_storeu_epi8(buf + grp.slots[k].dst, grp.slots[k].mask, d);
+    }
+#else
+    for (uint32_t i = 0; i < N; i++) fns[i](buf + offsets[i], nums[i]);
+#endif
+  }
+
+private:
+#if defined(__AVX512VL__) && defined(__AVX512BW__)
+  static const uint32_t GroupChunks = 4;
+
+  // a field whose digits end at some byte end of the group, written by a masked store at buf + dst
+  struct Slot
+  {
+    int32_t dst;
+    uint32_t mask;
+  };
+
+  // the chunks of each group: kind 1 is num % 10^8, 2 is num / 10^8 % 10^8, 3 is num / 10^16 and 0 is unused
+  struct Group
+  {
+    uint32_t idx[GroupChunks];
+    uint32_t kind[GroupChunks];
+    uint32_t n_chunks;
+    uint32_t n_slots;
+    Slot slots[GroupChunks];
+  };
+
+  static uint32_t chunk(uint64_t num, uint32_t kind) {
+    switch (kind) {
+      case 1: return num % 100000000;
+      case 2: return num / 100000000 % 100000000;
+      case 3: return num / 10000000000000000ULL;
+    }
+    return 0;
+  }
+
+  // field i of width digits at offset, taking the lowest chunks of nums[i]
+  void addField(uint32_t i, uint32_t offset, uint32_t width, uint32_t chunks) {
+    uint32_t g = 0;
+    while (g < n_groups && groups[g].n_chunks + chunks > GroupChunks) g++;
+    if (g == n_groups) groups[n_groups++] = Group();
+    Group& grp = groups[g];
+    for (uint32_t k = 0; k < chunks; k++) {
+      grp.idx[grp.n_chunks] = i;
+      grp.kind[grp.n_chunks++] = chunks - k;
+    }
+    uint32_t end = grp.n_chunks * 8;
+    grp.slots[grp.n_slots++] = {(int32_t)(offset + width - end), (uint32_t)(((1ull << width) - 1) << (end - width))};
+  }
+
+  // each group has at least one field
+  Group groups[N];
+  uint32_t n_groups = 0;
+#else
+  template<size_t W>
+  static void fromiW(char* p, uint64_t num) {
+    ((Str<W>*)p)->fromi(num);
+  }
+
+  uint32_t offsets[N];
+  void (*fns[N])(char*, uint64_t);
+#endif
+};
@@ -27,6 +27,19 @@ SOFTWARE.
 #include <map>
 #include <algorithm>
 #include <memory>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <type_traits>
+#include <cstdio>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace strhash_detail {
 
@@ -58,16 +71,70 @@ inline uint32_t intHash(const Str<8>& s) { // simply truncate to lower 4 bytes
   return (uint32_t)(*(uint64_t*)&s);
 }
 
+inline uint64_t lenMask(uint32_t len) { return len >= 64 ? ~0ULL : (1ULL << len) - 1; }
+
+// length of a key padded with trailing PadCh
+template<char PadCh, size_t StrSZ>
+inline uint32_t keyLen(const Str<StrSZ>& key) {
+#ifdef __AVX512BW__
+  if (StrSZ <= 64) {
+    __m512i v = _mm512_maskz_loadu_epi8(lenMask(StrSZ), key.s);
+    uint64_t m = _mm512_mask_cmpneq_epi8_mask(lenMask(StrSZ), v, _mm512_set1_epi8(PadCh));
+    return m ? 64 - __builtin_clzll(m) : 0;
+  }
+#endif
+  uint32_t len = StrSZ;
+  while (len && key.s[len - 1] == PadCh) len--;
+  return len;
+}
+
+// a key of len(<= StrSZ) chars at p padded with trailing PadCh. with AVX512BW it's a masked load with PadCh filled in
+// the other lanes, which never reads past p + len, followed by a full store so that loads of the key are forwarded
+template<size_t StrSZ, char PadCh>
+struct PaddedKey
+{
+  alignas(64) char buf[(StrSZ + 63) & ~size_t(63)];
+
+  PaddedKey(const char* p, uint32_t len) {
+#ifdef __AVX512BW__
+    if (StrSZ <= 64) {
+      __m512i v = _mm512_mask_loadu_epi8(_mm512_set1_epi8(PadCh), lenMask(len), p);
+      _mm512_store_si512((__m512i*)buf, v);
+      return;
+    }
+#endif
+    memcpy(buf, p, len);
+    memset(buf + len, PadCh, StrSZ - len);
+  }
+
+  const Str<StrSZ>& key() const { return *(const Str<StrSZ>*)buf; }
+};
+
 } // namespace
 
-template<size_t StrSZ, typename ValueT, ValueT NullV = 0, uint32_t HashFunc = 0, bool SmallTbl = true>
-class StrHash : public std::map<Str<StrSZ>, ValueT>
+// StrHashBuilder trains the hashing parameters on a set of keys and builds an immutable Table from them, the keys and
+// values can come from any source(arrays, a vector of pairs, a mmapped file...) without a std::map.
+// SoALayout: if true, hash values, keys and values are stored in 3 separate arrays so that probing scans contiguous hash
+// values and only touches the key on a hash value match, otherwise they are interleaved in Bucket
+// VarLen: keys could be shorter than StrSZ and are stored padded with trailing PadCh(e.g. '\0' or ' '), then they can
+// also be searched by (ptr, len) without being padded by the caller
+// MaxProbeLen: if not 0, no key is placed further than MaxProbeLen buckets from its hash value, the table size is
+// doubled until it holds or building fails, and a search stops after MaxProbeLen + 1 buckets, so a miss scans no more
+// CostFunc: how training scores hashing parameters, 0: sum of squared bucket occupancy, 1: probe distances of hits and
+// misses in the placed table, weighted by MissPct(percentage of searched keys not in the table), see calcProbeCost
+template<size_t StrSZ, typename ValueT, ValueT NullV = 0, uint32_t HashFunc = 0, bool SmallTbl = true,
+         bool SoALayout = false, bool VarLen = false, char PadCh = '\0', uint32_t MaxProbeLen = 0,
+         uint32_t CostFunc = 0, uint32_t MissPct = 0>
+class StrHashBuilder
 {
 public:
   using KeyT = Str<StrSZ>;
-  using Parent = std::map<KeyT, ValueT>;
   using HashT = typename strhash_detail::HashType<SmallTbl>::type;
   static const uint32_t MaxTblSZ = 1u << (SmallTbl ? 15 : 31);
+  // default sample size of training: with more keys, candidates are evaluated on a sample, see findBest
+  static const uint32_t TrainSampleSZ = 1u << 20;
+  // number of the best candidates on a sample which are validated on all keys
+  static const uint32_t TrainTopK = 4;
   struct Bucket
   {
     alignas(KeyT::AlignSize) KeyT key;
@@ -76,114 +143,528 @@ public:
     Bucket() = default;
     Bucket(const KeyT& k, const ValueT& v) : key(k), value(v) {}
   };
+  // hashing parameters found by training
+  struct HashParam
+  {
+    uint32_t hash_salt;
+    HashT tbl_mask;
+    uint16_t hash_pos_len;
+    uint16_t hash_pos[StrSZ];
+  };
 
-  bool doneModify() {
-    uint32_t n = Parent::size();
-    if (n >= MaxTblSZ) return false;
-    table_size = n;
-    std::vector<Bucket> tmp_tbl;
-    tmp_tbl.reserve(n);
-    for (auto& pr : *this) {
-      tmp_tbl.emplace_back(pr.first, pr.second);
-    }
-    findBest(tmp_tbl);
-    for (auto& blk : tmp_tbl) {
-      blk.hashv = calcHash(blk.key);
-    }
-    std::sort(tmp_tbl.begin(), tmp_tbl.end(), [](const Bucket& a, const Bucket& b) { return a.hashv < b.hashv; });
-    HashT size = tbl_mask + 1;
-    tbl.reset(new Bucket[size]);
-    for (HashT i = 0; i < size; i++) {
-      tbl[i].hashv = size;
-    }
-    for (auto& blk : tmp_tbl) {
-      for (HashT pos = blk.hashv;; pos = (pos + 1) & tbl_mask) {
-        if (tbl[pos].hashv == size) {
-          tbl[pos] = blk;
-          break;
+  // a trained table which is immutable once built
+  class Table
+  {
+  public:
+    ValueT fastFind(const KeyT& key) const { return probe(key, calcHash(key, param)); }
+
+    // search a key of len chars at p, which is padded to StrSZ in a vector register for hashing and the key compare
+    ValueT fastFind(const char* p, uint32_t len) const {
+      static_assert(VarLen, "only for VarLen keys");
+      if (len > StrSZ) return NullV;
+      return fastFind(strhash_detail::PaddedKey<StrSZ, PadCh>(p, len).key());
+    }
+
+    // find n keys at once: all hashes are calculated and their buckets prefetched before probing,
+    // so that the cache misses of different keys can overlap
+    void fastFindBatch(const KeyT* keys, ValueT* values, uint32_t n) const {
+      findBatch(n, values, [keys](uint32_t i) -> const KeyT& { return keys[i]; });
+    }
+
+    // same as above but keys are given as pointers, e.g. pointing to fields in a packet buffer
+    void fastFindBatch(const KeyT* const* keys, ValueT* values, uint32_t n) const {
+      findBatch(n, values, [keys](uint32_t i) -> const KeyT& { return *keys[i]; });
+    }
+
+    uint32_t getTableSize() const { return table_size; }
+
+    // number of keys at each distance from their hash values, i.e. the extra buckets scanned by a hit
+    std::vector<uint64_t> getProbeHist() const {
+      std::vector<uint64_t> hist;
+      if (!getMem()) return hist;
+      uint64_t n = (uint64_t)param.tbl_mask + 1;
+      for (uint64_t pos = 0; pos < n; pos++) {
+        uint64_t h = SoALayout ? tags[pos] : tbl[pos].hashv;
+        if (h == n) continue;
+        uint64_t dist = (pos - h) & param.tbl_mask;
+        if (dist >= hist.size()) hist.resize(dist + 1);
+        hist[dist]++;
+      }
+      return hist;
+    }
+
+    const HashParam& getHashParam() const { return param; }
+
+    Table() = default;
+    Table(const Table&) = delete;
+    Table& operator=(const Table&) = delete;
+    Table(Table&& o) { *this = std::move(o); }
+    // the bucket memory or the mapping is handed over, o is left empty
+    Table& operator=(Table&& o) {
+      if (this == &o) return *this;
+      release();
+      tbl = o.tbl;
+      tags = o.tags;
+      keys = o.keys;
+      vals = o.vals;
+      param = o.param;
+      table_size = o.table_size;
+      mem_buf = std::move(o.mem_buf);
+      map_addr = o.map_addr;
+      map_size = o.map_size;
+      o.map_addr = nullptr;
+      o.release();
+      o.table_size = 0;
+      return *this;
+    }
+    ~Table() { release(); }
+
+    // save the trained table into a file, which is written to a temp file first and then renamed to path,
+    // so processes loading the same path never see a partial file
+    bool save(const char* path) const {
+      static_assert(std::is_trivially_copyable<ValueT>::value, "ValueT can't be saved");
+      if (!getMem()) return false;
+      FileHeader header;
+      fillHeader(header);
+      uint64_t tbl_bytes = memSize(header.n_buckets);
+      header.checksum = checksum(&header, getMem(), tbl_bytes);
+      std::string tmp_path = std::string(path) + ".tmp";
+      FILE* fp = fopen(tmp_path.c_str(), "wb");
+      if (!fp) return false;
+      bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 && fwrite(getMem(), tbl_bytes, 1, fp) == 1;
+      ok = (fclose(fp) == 0) && ok;
+      if (ok) ok = rename(tmp_path.c_str(), path) == 0;
+      if (!ok) unlink(tmp_path.c_str());
+      return ok;
+    }
+
+    // mmap a file saved by save read-only, so fastFind works on it without copying and its pages are shared between
+    // processes. The file is rejected if it's saved from a StrHash of different template parameters or corrupted
+    bool load(const char* path, bool verify_checksum = true) {
+      static_assert(std::is_trivially_copyable<ValueT>::value, "ValueT can't be loaded");
+      int fd = open(path, O_RDONLY);
+      if (fd < 0) return false;
+      struct stat st;
+      void* addr = MAP_FAILED;
+      if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(FileHeader)) {
+        addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      }
+      close(fd);
+      if (addr == MAP_FAILED) return false;
+      const FileHeader& header = *(const FileHeader*)addr;
+      const char* mem = (const char*)addr + sizeof(FileHeader);
+      FileHeader expected;
+      fillHeader(expected);
+      uint64_t tbl_bytes = memSize(header.n_buckets);
+      if (memcmp(header.magic, expected.magic, sizeof(header.magic)) || header.version != expected.version ||
+          header.str_size != expected.str_size || header.value_size != expected.value_size ||
+          header.hash_func != expected.hash_func || header.small_tbl != expected.small_tbl ||
+          header.bucket_size != expected.bucket_size || header.soa_layout != expected.soa_layout ||
+          header.var_len != expected.var_len || header.pad_ch != expected.pad_ch ||
+          header.n_buckets != (uint64_t)header.param.tbl_mask + 1 ||
+          !StrHashBuilder::validParam(header.param, 1, MaxTblSZ) ||
+          st.st_size != (off_t)(sizeof(FileHeader) + tbl_bytes) ||
+          (verify_checksum && header.checksum != checksum(&header, mem, tbl_bytes))) {
+        munmap(addr, st.st_size);
+        return false;
+      }
+      release();
+      param = header.param;
+      table_size = header.table_size;
+      setMem(mem);
+      map_addr = addr;
+      map_size = st.st_size;
+      return true;
+    }
+
+  private:
+    friend class StrHashBuilder;
+    static const uint32_t BatchSZ = 16;
+    static const uint32_t FileVersion = 3;
+
+    // file layout: FileHeader followed by the bucket memory
+    struct alignas(64) FileHeader
+    {
+      char magic[8];
+      uint32_t version;
+      uint32_t str_size;
+      uint32_t value_size;
+      uint32_t hash_func;
+      uint32_t small_tbl;
+      uint32_t bucket_size;
+      uint32_t soa_layout;
+      uint32_t var_len;
+      uint32_t pad_ch;
+      uint32_t table_size;
+      uint32_t n_buckets;
+      uint64_t checksum; // of the whole file with this field being 0
+      HashParam param;
+    };
+
+    void fillHeader(FileHeader& header) const {
+      memset(&header, 0, sizeof(header));
+      memcpy(header.magic, "STRHASH", 8);
+      header.version = FileVersion;
+      header.str_size = StrSZ;
+      header.value_size = sizeof(ValueT);
+      header.hash_func = HashFunc;
+      header.small_tbl = SmallTbl;
+      header.bucket_size = sizeof(Bucket);
+      header.soa_layout = SoALayout;
+      header.var_len = VarLen;
+      header.pad_ch = (uint8_t)PadCh;
+      header.table_size = table_size;
+      header.n_buckets = (uint64_t)param.tbl_mask + 1;
+      header.param = param;
+    }
+
+    // FNV-1a on 8 bytes words
+    static uint64_t checksum(const FileHeader* header, const void* data, uint64_t size) {
+      FileHeader h = *header;
+      h.checksum = 0;
+      uint64_t ret = checksum(14695981039346656037ULL, &h, sizeof(h));
+      return checksum(ret, data, size);
+    }
+
+    static uint64_t checksum(uint64_t h, const void* data, uint64_t size) {
+      const char* p = (const char*)data;
+      for (; size >= 8; p += 8, size -= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 1099511628211ULL;
+      }
+      for (; size; p++, size--) h = (h ^ (uint8_t)*p) * 1099511628211ULL;
+      return h;
+    }
+
+    static uint64_t alignUp(uint64_t size) { return (size + 63) & ~63ULL; }
+
+    // bytes of the bucket memory of n buckets
+    // AoS: Bucket[n]
+    // SoA: HashT[n], KeyT[n] and ValueT[n], each aligned to 64 bytes
+    static uint64_t memSize(uint64_t n) {
+      if (SoALayout) return alignUp(n * sizeof(HashT)) + alignUp(n * sizeof(KeyT)) + alignUp(n * sizeof(ValueT));
+      return alignUp(n * sizeof(Bucket));
+    }
+
+    const char* getMem() const { return SoALayout ? (const char*)tags : (const char*)tbl; }
+
+    // point to the bucket memory of which the number of buckets is given by param
+    void setMem(const char* mem) {
+      uint64_t n = (uint64_t)param.tbl_mask + 1;
+      if (SoALayout) {
+        tags = (const HashT*)mem;
+        keys = (const KeyT*)(mem + alignUp(n * sizeof(HashT)));
+        vals = (const ValueT*)((const char*)keys + alignUp(n * sizeof(KeyT)));
+      }
+      else {
+        tbl = (const Bucket*)mem;
+      }
+    }
+
+    // place buckets sorted by hash value into newly allocated bucket memory of tbl_mask + 1 buckets in the layout, each
+    // one at the first empty slot from its hash value, where an empty slot has a hash value of table size.
+    // max_dist is set to the longest distance of a key from its hash value. returns nullptr if allocation fails
+    static char* placeBuckets(const std::vector<Bucket>& sorted, HashT tbl_mask, uint64_t& max_dist) {
+      uint64_t n = (uint64_t)tbl_mask + 1;
+      uint64_t size = memSize(n);
+      char* mem = (char*)aligned_alloc(64, size);
+      if (!mem) return nullptr;
+      memset(mem, 0, size);
+      Bucket* b = (Bucket*)mem;
+      HashT* h = (HashT*)mem;
+      KeyT* k = (KeyT*)(mem + alignUp(n * sizeof(HashT)));
+      ValueT* v = (ValueT*)((char*)k + alignUp(n * sizeof(KeyT)));
+      auto tag = [&](HashT pos) -> HashT& { return SoALayout ? h[pos] : b[pos].hashv; };
+      for (uint64_t i = 0; i < n; i++) {
+        tag(i) = n;
+      }
+      max_dist = 0;
+      for (auto& blk : sorted) {
+        HashT pos = blk.hashv;
+        while (tag(pos) != (HashT)n) pos = (pos + 1) & tbl_mask;
+        max_dist = std::max(max_dist, (uint64_t)(HashT)(pos - blk.hashv) & tbl_mask);
+        if (SoALayout) {
+          h[pos] = blk.hashv;
+          k[pos] = blk.key;
+          v[pos] = blk.value;
+        }
+        else {
+          b[pos] = blk;
         }
       }
+      return mem;
     }
 
-    return true;
+    // use the memory got by placeBuckets for param
+    void setBuckets(char* mem) {
+      release();
+      mem_buf.reset(mem);
+      setMem(mem);
+    }
+
+    void release() {
+      mem_buf.reset();
+      if (map_addr) munmap(map_addr, map_size);
+      map_addr = nullptr;
+      tbl = nullptr;
+      tags = nullptr;
+      keys = nullptr;
+      vals = nullptr;
+    }
+
+#ifdef __AVX2__
+    // number of tags scanned at once, and bits per tag in the masks.
+    // this is also used with AVX512, where mask compares over 256 or 512 bits are found to be slower
+    static const uint32_t TagGroupSZ = 32 / sizeof(HashT);
+    static const uint32_t TagMaskBits = sizeof(HashT);
+
+    // compare TagGroupSZ tags starting from p with hash, return bit masks of equal and greater ones.
+    // AVX2 has no unsigned compare, so t > h is got by max(t, h) != h
+    static void scanTags(const HashT* p, HashT hash, uint64_t& eq, uint64_t& gt) {
+      __m256i t = _mm256_loadu_si256((const __m256i*)p);
+      if (sizeof(HashT) == 2) {
+        __m256i h = _mm256_set1_epi16(hash);
+        eq = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(t, h));
+        gt = (uint32_t)~_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_max_epu16(t, h), h));
+      }
+      else {
+        __m256i h = _mm256_set1_epi32(hash);
+        eq = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi32(t, h));
+        gt = (uint32_t)~_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_max_epu32(t, h), h));
+      }
+    }
+
+    // scan tags a group at a time while the group doesn't wrap around, and leave the rest to the scalar loop.
+    // with MaxProbeLen, the tags beyond hash + MaxProbeLen in the last group are ignored
+    ValueT probeSimd(const KeyT& key, HashT hash) const {
+      // most searches end at the first bucket, which is faster to be checked alone
+      if (tags[hash] > hash) return NullV;
+      if (tags[hash] == hash && keys[hash] == key) return vals[hash];
+      uint64_t size = (uint64_t)param.tbl_mask + 1;
+      uint64_t pos = hash + 1;
+      for (; pos + TagGroupSZ <= size; pos += TagGroupSZ) {
+        uint64_t eq, gt;
+        scanTags(tags + pos, hash, eq, gt);
+        // only the tags before the first greater one are to be checked
+        if (gt) eq &= (gt & -gt) - 1;
+        bool last = MaxProbeLen && pos + TagGroupSZ > hash + MaxProbeLen;
+        if (last) eq &= (1ULL << ((hash + MaxProbeLen + 1 - pos) * TagMaskBits)) - 1;
+        while (eq) {
+          uint32_t i = __builtin_ctzll(eq) / TagMaskBits;
+          if (keys[pos + i] == key) return vals[pos + i];
+          eq &= ~0ULL << ((i + 1) * TagMaskBits);
+        }
+        if (gt || last) return NullV;
+      }
+      return probeScalar(key, hash, pos & param.tbl_mask);
+    }
+#endif
+
+    ValueT probe(const KeyT& key, HashT hash) const {
+      if (SoALayout) {
+#ifdef __AVX2__
+        return probeSimd(key, hash);
+#else
+        return probeScalar(key, hash, hash);
+#endif
+      }
+      for (HashT pos = hash;; pos = (pos + 1) & param.tbl_mask) {
+        if (tbl[pos].hashv > hash) return NullV;
+        // it's likely that tbl[pos].hash == hash so we skip checking it
+        if (/*tbl[pos].hash == hash && */ tbl[pos].key == key) return tbl[pos].value;
+        // otherwise a miss wrapping around the end would scan all the low hash values at the start
+        if (MaxProbeLen && ((pos - hash) & param.tbl_mask) >= MaxProbeLen) return NullV;
+      }
+    }
+
+    // SoA probing starting from pos
+    ValueT probeScalar(const KeyT& key, HashT hash, HashT pos) const {
+      for (;; pos = (pos + 1) & param.tbl_mask) {
+        if (tags[pos] > hash) return NullV;
+        if (tags[pos] == hash && keys[pos] == key) return vals[pos];
+        if (MaxProbeLen && ((pos - hash) & param.tbl_mask) >= MaxProbeLen) return NullV;
+      }
+    }
+
+    template<typename GetKey>
+    void findBatch(uint32_t n, ValueT* values, GetKey getKey) const {
+      HashT hashes[BatchSZ];
+      for (uint32_t start = 0; start < n; start += BatchSZ) {
+        uint32_t cnt = std::min(n - start, BatchSZ);
+        for (uint32_t i = 0; i < cnt; i++) {
+          hashes[i] = calcHash(getKey(start + i), param);
+          if (SoALayout) {
+            __builtin_prefetch(&tags[hashes[i]]);
+            __builtin_prefetch(&keys[hashes[i]]);
+          }
+          else {
+            __builtin_prefetch(&tbl[hashes[i]]);
+          }
+        }
+        for (uint32_t i = 0; i < cnt; i++) {
+          values[start + i] = probe(getKey(start + i), hashes[i]);
+        }
+      }
+    }
+
+    alignas(64) const Bucket* tbl = nullptr; // AoS
+    const HashT* tags = nullptr;              // SoA
+    const KeyT* keys = nullptr;               // SoA
+    const ValueT* vals = nullptr;             // SoA
+    HashParam param;
+    uint32_t table_size = 0;
+    // bucket memory is either allocated by buildTable or mmapped by load
+    std::unique_ptr<char, decltype(&free)> mem_buf{nullptr, &free};
+    void* map_addr = nullptr;
+    size_t map_size = 0;
+  };
+
+  // build t from n keys and their values, e.g. arrays in a file mmapped by the caller. keys must be distinct, otherwise
+  // false is returned and t is untouched.
+  // n_threads: number of threads used to search for the best hashing parameters, the result is the same regardless of
+  // n_threads. init_param: warm start from parameters trained before, see StrHash::doneModify.
+  // sample_size: train on a sample of at most sample_size keys if there're more, 0 to always train on all keys
+  static bool build(Table& t, const KeyT* keys, const ValueT* values, uint64_t n, uint32_t n_threads = 1,
+                    const HashParam* init_param = nullptr, uint64_t sample_size = TrainSampleSZ) {
+    if (n >= MaxTblSZ) return false;
+    std::vector<Bucket> tmp_tbl;
+    tmp_tbl.reserve(n);
+    for (uint64_t i = 0; i < n; i++) {
+      tmp_tbl.emplace_back(keys[i], values[i]);
+    }
+    return buildBuckets(t, tmp_tbl, n_threads, init_param, sample_size);
   }
 
-  ValueT fastFind(const KeyT& key) const {
-    HashT hash = calcHash(key);
-    for (HashT pos = hash;; pos = (pos + 1) & tbl_mask) {
-      if (tbl[pos].hashv > hash) return NullV;
-      // it's likely that tbl[pos].hash == hash so we skip checking it
-      if (/*tbl[pos].hash == hash && */ tbl[pos].key == key) return tbl[pos].value;
+  // same as above from a forward iterator range of (key, value) pairs, e.g. a std::vector<std::pair<KeyT, ValueT>>
+  template<typename Iter>
+  static bool build(Table& t, Iter first, Iter last, uint32_t n_threads = 1, const HashParam* init_param = nullptr,
+                    uint64_t sample_size = TrainSampleSZ) {
+    uint64_t n = std::distance(first, last);
+    if (n >= MaxTblSZ) return false;
+    std::vector<Bucket> tmp_tbl;
+    tmp_tbl.reserve(n);
+    for (; first != last; ++first) {
+      tmp_tbl.emplace_back(first->first, first->second);
     }
+    return buildBuckets(t, tmp_tbl, n_threads, init_param, sample_size);
   }
 
-  uint32_t getTableSize() const { return table_size; }
+  // a VarLen key from len(<= StrSZ) chars at p
+  static KeyT makeKey(const char* p, uint32_t len) {
+    static_assert(VarLen, "only for VarLen keys");
+    return strhash_detail::PaddedKey<StrSZ, PadCh>(p, len).key();
+  }
 
 private:
-  bool HashFuncUseSalt() const { return HashFunc != 3; }
-  bool HashFuncUsePos() const { return HashFunc != 5; }
+  // a set of hashing parameters to evaluate in findBest
+  struct Candidate
+  {
+    uint16_t hash_pos_len;
+    HashT tbl_mask;
+    uint32_t hash_salt;
+    uint32_t group;
+  };
+
+  static bool buildBuckets(Table& t, std::vector<Bucket>& tmp_tbl, uint32_t n_threads, const HashParam* init_param,
+                           uint64_t sample_size) {
+    HashParam param;
+    findBest(tmp_tbl, std::max(n_threads, 1u), init_param, sample_size, param);
+    for (;;) {
+      for (auto& blk : tmp_tbl) {
+        blk.hashv = calcHash(blk.key, param);
+      }
+      // duplicate keys are adjacent after sorting
+      std::sort(tmp_tbl.begin(), tmp_tbl.end(), [](const Bucket& a, const Bucket& b) {
+        return a.hashv < b.hashv || (a.hashv == b.hashv && a.key < b.key);
+      });
+      for (size_t i = 1; i < tmp_tbl.size(); i++) {
+        if (tmp_tbl[i].key == tmp_tbl[i - 1].key) return false;
+      }
+      uint64_t max_dist;
+      char* mem = Table::placeBuckets(tmp_tbl, param.tbl_mask, max_dist);
+      if (!mem) return false;
+      if (!MaxProbeLen || max_dist <= MaxProbeLen) {
+        t.param = param;
+        t.table_size = tmp_tbl.size();
+        t.setBuckets(mem);
+        return true;
+      }
+      free(mem);
+      // a larger table with the same hashing parameters has shorter clusters
+      uint64_t tbl_size = (uint64_t)param.tbl_mask + 1;
+      if (tbl_size * 2 > MaxTblSZ) return false;
+      param.tbl_mask = tbl_size * 2 - 1;
+    }
+  }
+
+  static bool HashFuncUseSalt() { return HashFunc != 3; }
+  static bool HashFuncUsePos() { return HashFunc != 5 && HashFunc != 7; }
 
-  HashT calcHash(const KeyT& key) const {
-    static_assert(HashFunc <= 6, "unsupported HashFunc");
+  static HashT calcHash(const KeyT& key, const HashParam& p) {
+    static_assert(HashFunc <= 7, "unsupported HashFunc");
     uint32_t hash;
     switch (HashFunc) {
-      case 0: hash = djbHash1(key); break;
-      case 1: hash = djbHash2(key); break;
-      case 2: hash = saxHash(key); break;
-      case 3: hash = fnvHash(key); break;
-      case 4: hash = oatHash(key); break;
-      case 5: hash = murmurHash(key); break;
-      case 6: hash = intHash(key); break;
+      case 0: hash = djbHash1(key, p); break;
+      case 1: hash = djbHash2(key, p); break;
+      case 2: hash = saxHash(key, p); break;
+      case 3: hash = fnvHash(key, p); break;
+      case 4: hash = oatHash(key, p); break;
+      case 5: hash = murmurHash(key, p); break;
+      case 6: hash = intHash(key, p); break;
+      case 7: hash = mixHash64(key, p); break;
     }
+    // keys sharing a prefix are mostly of different lengths, which the sampled positions may not cover
+    if (VarLen) hash += strhash_detail::keyLen<PadCh>(key) * 0x9e3779b9;
     if (SmallTbl) hash ^= (hash >> 16);
-    return (HashT)hash & tbl_mask;
+    return (HashT)hash & p.tbl_mask;
   }
 
   // 0
-  uint32_t djbHash1(const KeyT& key) const {
-    uint32_t h = hash_salt;
-    for (int i = 0; i < hash_pos_len; i++) {
-      char ch = key.s[hash_pos[i]];
+  static uint32_t djbHash1(const KeyT& key, const HashParam& p) {
+    uint32_t h = p.hash_salt;
+    for (int i = 0; i < p.hash_pos_len; i++) {
+      char ch = key.s[p.hash_pos[i]];
       h = ((h << 5) + h) + ch;
     }
     return h;
   }
 
   // 1
-  uint32_t djbHash2(const KeyT& key) const {
-    uint32_t h = hash_salt;
-    for (int i = 0; i < hash_pos_len; i++) {
-      char ch = key.s[hash_pos[i]];
+  static uint32_t djbHash2(const KeyT& key, const HashParam& p) {
+    uint32_t h = p.hash_salt;
+    for (int i = 0; i < p.hash_pos_len; i++) {
+      char ch = key.s[p.hash_pos[i]];
       h = ((h << 5) + h) ^ ch;
     }
     return h;
   }
 
   // 2
-  uint32_t saxHash(const KeyT& key) const {
-    uint32_t h = hash_salt;
-    for (int i = 0; i < hash_pos_len; i++) {
-      char ch = key.s[hash_pos[i]];
+  static uint32_t saxHash(const KeyT& key, const HashParam& p) {
+    uint32_t h = p.hash_salt;
+    for (int i = 0; i < p.hash_pos_len; i++) {
+      char ch = key.s[p.hash_pos[i]];
       h ^= (h << 5) + (h >> 2) + ch;
     }
     return h;
   }
 
   // 3, hash_salt is not used
-  uint32_t fnvHash(const KeyT& key) const {
+  static uint32_t fnvHash(const KeyT& key, const HashParam& p) {
     uint32_t h = 2166136261;
-    for (int i = 0; i < hash_pos_len; i++) {
-      char ch = key.s[hash_pos[i]];
+    for (int i = 0; i < p.hash_pos_len; i++) {
+      char ch = key.s[p.hash_pos[i]];
       h = (h * 16777619) ^ ch;
     }
     return h;
   }
 
   // 4
-  uint32_t oatHash(const KeyT& key) const {
-    uint32_t h = hash_salt;
-    for (int i = 0; i < hash_pos_len; i++) {
-      char ch = key.s[hash_pos[i]];
+  static uint32_t oatHash(const KeyT& key, const HashParam& p) {
+    uint32_t h = p.hash_salt;
+    for (int i = 0; i < p.hash_pos_len; i++) {
+      char ch = key.s[p.hash_pos[i]];
       h += ch;
       h += (h << 10);
       h ^= (h >> 6);
@@ -195,13 +676,13 @@ private:
   }
 
   // 5, hash_pos is not used
-  uint32_t murmurHash(const KeyT& key) const {
+  static uint32_t murmurHash(const KeyT& key, const HashParam& p) {
     const unsigned int m = 0x5bd1e995;
     const int r = 24;
     int len = StrSZ;
 
     // Initialize the hash to a 'random' value
-    unsigned int h = hash_salt ^ len;
+    unsigned int h = p.hash_salt ^ len;
 
     // Mix 4 bytes at a time into the hash
     const unsigned char* data = (const unsigned char*)key.s;
@@ -231,80 +712,345 @@ private:
   }
 
   // 6: when key is actually an integer(e.g. uint32_t or uint64_t), return itself as hash value
-  uint32_t intHash(const KeyT& key) const { return strhash_detail::intHash<KeyT>(key); }
+  static uint32_t intHash(const KeyT& key, const HashParam& p) { return strhash_detail::intHash<KeyT>(key); }
 
-  void findBest(std::vector<Bucket>& tmp_tbl) {
+  // 7, 64 bit multiply-xorshift over 8 bytes words of the whole key folded to 32 bits, hash_pos is not used.
+  // for tables of tens of millions of keys which a hash over a few positions can't spread well
+  static uint32_t mixHash64(const KeyT& key, const HashParam& p) {
+    uint64_t h = (p.hash_salt + 1) * 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < StrSZ; i += 8) {
+      uint64_t w = 0;
+      memcpy(&w, key.s + i, std::min<size_t>(8, StrSZ - i));
+      h = (h ^ w) * 0xbf58476d1ce4e5b9ULL;
+      h ^= h >> 31;
+    }
+    h *= 0x94d049bb133111ebULL;
+    return h ^ (h >> 32);
+  }
+
+  static void findBest(const std::vector<Bucket>& tmp_tbl, uint32_t n_threads, const HashParam* init_param,
+                       uint64_t sample_size, HashParam& param) {
     uint64_t n = tmp_tbl.size();
-    std::map<char, uint64_t> chmap[StrSZ];
+    uint64_t max_cost = n * n;
+    uint64_t good_cost = goodCost(n);
+
+    uint64_t init_tbl_size = 1;
+    while (init_tbl_size <= n) init_tbl_size <<= 1;
+    uint64_t max_tbl_size = std::min(init_tbl_size * 4, (uint64_t)MaxTblSZ);
+
+    // try the warm start parameters first, and search only if they're not good enough for the current keys
+    if (init_param && validParam(*init_param, init_tbl_size, max_tbl_size)) {
+      std::vector<uint32_t> pos_cnt((uint64_t)init_param->tbl_mask + 1);
+      std::vector<HashT> hashes(n);
+      if (calcCost(tmp_tbl, *init_param, pos_cnt.data(), hashes.data(), good_cost + 1) <= good_cost) {
+        param = *init_param;
+        return;
+      }
+    }
+
+    // per position counters of each byte value
+    std::vector<std::array<uint32_t, 256>> chcnt(StrSZ);
     for (auto& bkt : tmp_tbl) {
       for (size_t i = 0; i < StrSZ; i++) {
-        chmap[i][bkt.key.s[i]]++;
+        chcnt[i][(uint8_t)bkt.key.s[i]]++;
       }
     }
     std::pair<uint64_t, int> chcost[StrSZ];
     for (size_t i = 0; i < StrSZ; i++) {
       chcost[i].second = i;
       chcost[i].first = 0;
-      for (auto& mppr : chmap[i]) {
-        chcost[i].first += mppr.second * mppr.second;
+      for (uint64_t cnt : chcnt[i]) {
+        chcost[i].first += cnt * cnt;
       }
     }
     std::sort(chcost, chcost + StrSZ);
     for (size_t i = 0; i < StrSZ; i++) {
-      hash_pos[i] = chcost[i].second;
+      param.hash_pos[i] = chcost[i].second;
     }
-    uint64_t max_cost = n * n;
-    uint64_t min_cost = n;
-    uint64_t good_cost = n + n / 3;
-
-    uint64_t init_tbl_size = 1;
-    while (init_tbl_size <= n) init_tbl_size <<= 1;
-    uint64_t max_tbl_size = std::min(init_tbl_size * 4, (uint64_t)MaxTblSZ);
+    // positions where all keys have the same char are not hashed
+    uint32_t pos_limit = 0;
+    while (pos_limit < StrSZ && chcost[pos_limit].first < max_cost) pos_limit++;
 
-    uint32_t best_pos_len = 0, best_mask = init_tbl_size - 1, best_salt = 0;
-    uint64_t best_cost = max_cost + 1;
-
-    for (hash_pos_len = 1; hash_pos_len <= StrSZ && chcost[hash_pos_len - 1].first < max_cost;
-         hash_pos_len += (HashFuncUsePos() ? 1 : StrSZ)) {
-      for (uint32_t tbl_size = init_tbl_size; tbl_size <= max_tbl_size; tbl_size <<= 1) {
-        tbl_mask = tbl_size - 1;
-        uint32_t max_salt = std::min((uint32_t)tbl_mask, 127U);
-        for (hash_salt = 0; hash_salt <= max_salt; hash_salt += (HashFuncUseSalt() ? 1 : tbl_size)) {
-          std::map<uint32_t, uint64_t> pos_mp;
-          for (auto& blk : tmp_tbl) {
-            uint32_t hash = calcHash(blk.key);
-            pos_mp[hash]++;
-          }
-          uint64_t cost = 0;
-          for (auto& mppr : pos_mp) {
-            cost += mppr.second * mppr.second;
-          }
+    // with more than sample_size keys, candidates are evaluated on a random sample of n >> shift keys in tables of
+    // 1 / 2^shift the sizes which have the same load factors. The best TrainTopK ones are scaled back and evaluated on
+    // all keys, and the best of them is used if its cost is good or not worse than expected from the sample. Otherwise
+    // the sample may need fewer positions to be distinguished than all keys, so the search goes on from a longer
+    // hash_pos_len, and at last on all keys
+    uint32_t shift = 0;
+    while (sample_size && (n >> shift) > sample_size) shift++;
+    if (shift) {
+      std::vector<Bucket> sample = sampleBuckets(tmp_tbl, n >> shift);
+      std::vector<HashT> hashes(n);
+      for (uint32_t min_pos_len = 1; min_pos_len <= pos_limit;) {
+        auto tops = searchParam(sample, n_threads, min_pos_len, pos_limit, init_tbl_size >> shift,
+                                max_tbl_size >> shift, TrainTopK, param);
+        if (tops.empty()) break;
+        // occupancy sums grow with the number of keys, while probe distances are averages
+        uint64_t limit = std::max(good_cost, CostFunc == 0 ? tops[0].first << shift : tops[0].first);
+        uint64_t best_cost = limit + 1;
+        for (auto& top : tops) {
+          HashParam p = top.second;
+          p.tbl_mask = (((uint64_t)p.tbl_mask + 1) << shift) - 1;
+          std::vector<uint32_t> pos_cnt((uint64_t)p.tbl_mask + 1);
+          uint64_t cost = calcCost(tmp_tbl, p, pos_cnt.data(), hashes.data(), best_cost);
           if (cost < best_cost) {
             best_cost = cost;
-            best_salt = hash_salt;
-            best_pos_len = hash_pos_len;
-            best_mask = tbl_mask;
-            /*
-            std::cout << "best_cost: " << best_cost << " best_salt: " << best_salt << " best_pos_len: " << best_pos_len
-                      << " best_mask: " << best_mask << " min_cost: " << min_cost << " good_cost: " << good_cost
-                      << std::endl;
-                      */
-            if (best_cost == min_cost) return;
+            param = p;
           }
         }
-        if (best_cost <= good_cost) goto done;
+        if (best_cost <= limit) return;
+        if (!HashFuncUsePos()) break;
+        min_pos_len = tops[0].second.hash_pos_len + 1;
       }
     }
-  done:
-    hash_salt = best_salt;
-    hash_pos_len = best_pos_len;
-    tbl_mask = best_mask;
+    auto tops = searchParam(tmp_tbl, n_threads, 1, pos_limit, init_tbl_size, max_tbl_size, 1, param);
+    if (tops.size()) {
+      param = tops[0].second;
+    }
+    else {
+      param.hash_salt = 0;
+      param.hash_pos_len = 0;
+      param.tbl_mask = init_tbl_size - 1;
+    }
   }
 
-  alignas(64) std::unique_ptr<Bucket[]> tbl;
-  uint32_t hash_salt;
-  HashT tbl_mask;
-  uint16_t hash_pos_len;
-  uint16_t hash_pos[StrSZ];
-  uint32_t table_size;
+  // m keys selected uniformly at random by a fixed seed, so the result of training is deterministic
+  static std::vector<Bucket> sampleBuckets(const std::vector<Bucket>& tmp_tbl, uint64_t m) {
+    std::vector<Bucket> sample;
+    sample.reserve(m);
+    std::mt19937_64 rng(m);
+    uint64_t n = tmp_tbl.size();
+    for (uint64_t i = 0; i < n && sample.size() < m; i++) {
+      if (rng() % (n - i) < m - sample.size()) sample.push_back(tmp_tbl[i]);
+    }
+    return sample;
+  }
+
+  // search candidates of hash_pos_len in [min_pos_len, pos_limit] and tables of init_tbl_size ~ max_tbl_size evaluated
+  // on keys with the hash_pos of param, and return at most top_k of them better than max cost, in the order of
+  // (cost, index of candidate)
+  static std::vector<std::pair<uint64_t, HashParam>> searchParam(const std::vector<Bucket>& keys, uint32_t n_threads,
+                                                                 uint32_t min_pos_len, uint32_t pos_limit,
+                                                                 uint64_t init_tbl_size, uint64_t max_tbl_size,
+                                                                 uint32_t top_k, const HashParam& param) {
+    uint64_t n = keys.size();
+    uint64_t min_cost, good_cost, max_cost;
+    costBounds(n, min_cost, good_cost, max_cost);
+
+    // candidates are enumerated in the order of (hash_pos_len, tbl_size, hash_salt), and those sharing the same
+    // (hash_pos_len, tbl_size) make up a group. The best ones are those of the lowest costs(the first ones on ties)
+    // among the groups up to the first group having a cost not larger than good_cost
+    std::vector<Candidate> cands;
+    std::vector<uint32_t> group_end;
+    for (uint32_t pos_len = min_pos_len; pos_len <= pos_limit; pos_len += (HashFuncUsePos() ? 1 : StrSZ)) {
+      for (uint64_t tbl_size = init_tbl_size; tbl_size <= max_tbl_size; tbl_size <<= 1) {
+        uint32_t max_salt = std::min((uint32_t)tbl_size - 1, 127U);
+        for (uint32_t salt = 0; salt <= max_salt; salt += (HashFuncUseSalt() ? 1 : tbl_size)) {
+          cands.push_back({(uint16_t)pos_len, (HashT)(tbl_size - 1), salt, (uint32_t)group_end.size()});
+        }
+        group_end.push_back(cands.size());
+      }
+    }
+
+    // each thread takes candidates in order and records (cost, index) whenever one gets into its local top_k, whose
+    // evaluation stops early once the cost reaches the local k-th best. As a thread only saw candidates of smaller
+    // indexes before, the global top_k are all recorded with exact costs.
+    // end_idx is lowered once a good enough candidate is found, so candidates before it are all evaluated
+    std::atomic<uint32_t> next_idx{0}, end_idx{(uint32_t)cands.size()};
+    std::vector<std::vector<std::pair<uint64_t, uint32_t>>> improvements(n_threads);
+    auto worker = [&](uint32_t tid) {
+      HashParam p = param;
+      std::vector<uint32_t> pos_cnt(max_tbl_size);
+      std::vector<HashT> hashes(n);
+      std::vector<uint64_t> top; // sorted costs of the local top_k
+      for (uint32_t i; (i = next_idx++) < end_idx;) {
+        const Candidate& cand = cands[i];
+        p.hash_pos_len = cand.hash_pos_len;
+        p.tbl_mask = cand.tbl_mask;
+        p.hash_salt = cand.hash_salt;
+        uint64_t limit = top.size() < top_k ? max_cost + 1 : top.back();
+        uint64_t cost = calcCost(keys, p, pos_cnt.data(), hashes.data(), limit);
+        if (cost >= limit) continue;
+        top.insert(std::upper_bound(top.begin(), top.end(), cost), cost);
+        if (top.size() > top_k) top.pop_back();
+        improvements[tid].emplace_back(cost, i);
+        uint32_t end = cost == min_cost ? i + 1 : cost <= good_cost ? group_end[cand.group] : (uint32_t)cands.size();
+        for (uint32_t cur = end_idx; end < cur && !end_idx.compare_exchange_weak(cur, end);)
+          ;
+      }
+    };
+    std::vector<std::thread> thrs;
+    for (uint32_t tid = 1; tid < n_threads; tid++) thrs.emplace_back(worker, tid);
+    worker(0);
+    for (auto& thr : thrs) thr.join();
+
+    uint32_t end = end_idx;
+    std::vector<std::pair<uint64_t, uint32_t>> best;
+    for (auto& imps : improvements) {
+      for (auto& imp : imps) {
+        if (imp.second < end) best.push_back(imp);
+      }
+    }
+    std::sort(best.begin(), best.end());
+    std::vector<std::pair<uint64_t, HashParam>> ret;
+    for (uint32_t i = 0; i < best.size() && i < top_k; i++) {
+      const Candidate& cand = cands[best[i].second];
+      ret.emplace_back(best[i].first, param);
+      ret.back().second.hash_salt = cand.hash_salt;
+      ret.back().second.hash_pos_len = cand.hash_pos_len;
+      ret.back().second.tbl_mask = cand.tbl_mask;
+    }
+    return ret;
+  }
+
+  // whether p could be a result of findBest for a table of which the initial size is init_tbl_size
+  static bool validParam(const HashParam& p, uint64_t init_tbl_size, uint64_t max_tbl_size) {
+    uint64_t tbl_size = (uint64_t)p.tbl_mask + 1;
+    if ((tbl_size & p.tbl_mask) || tbl_size < init_tbl_size || tbl_size > max_tbl_size) return false;
+    if (p.hash_pos_len > StrSZ) return false;
+    for (size_t i = 0; i < StrSZ; i++) {
+      if (p.hash_pos[i] >= StrSZ) return false;
+    }
+    return true;
+  }
+
+  // bounds of the cost of n keys: a candidate not better than max_cost is never used, the search stops at a candidate of
+  // min_cost, or at the end of the group of a candidate not worse than good_cost
+  static void costBounds(uint64_t n, uint64_t& min_cost, uint64_t& good_cost, uint64_t& max_cost) {
+    static_assert(CostFunc <= 1 && MissPct <= 100, "unsupported CostFunc or MissPct");
+    min_cost = CostFunc == 0 ? n : 0;
+    good_cost = goodCost(n);
+    max_cost = CostFunc == 0 ? n * n : ~0ULL >> 1;
+  }
+
+  static uint64_t goodCost(uint64_t n) {
+    // for probe distances: a hit scans 1/8 extra bucket and a miss 1/2 on average, and both at most 8 buckets
+    return CostFunc == 0 ? n + n / 3 : probeScore(8, 1, 8, 2, 1, 8);
+  }
+
+  // cost of hashing parameters p on the keys of tmp_tbl, evaluation stops early once it reaches limit.
+  // pos_cnt must be zeroed for the table size of p and is zeroed again on return
+  static uint64_t calcCost(const std::vector<Bucket>& tmp_tbl, const HashParam& p, uint32_t* pos_cnt, HashT* hashes,
+                           uint64_t limit) {
+    if (CostFunc == 1) return calcProbeCost(tmp_tbl, p, pos_cnt, hashes, limit);
+    // sum of squared bucket occupancy
+    uint64_t cost = 0;
+    uint32_t i = 0, n = tmp_tbl.size();
+    for (; i < n && cost < limit; i++) {
+      HashT hash = hashes[i] = calcHash(tmp_tbl[i].key, p);
+      // (c + 1)^2 - c^2
+      cost += pos_cnt[hash]++ * 2 + 1;
+    }
+    while (i) pos_cnt[hashes[--i]] = 0;
+    return cost;
+  }
+
+  // probe distances of the placement by buildBuckets approximated from the number of keys at each hash value: as keys
+  // are placed in the order of hash values, those reaching a bucket but not placed yet are carried on to the next one.
+  // A hit scans the buckets it's carried over, and a miss scans the keys carried into and hashed at its bucket, at most
+  // MaxProbeLen + 1 of them if it's set. The cost is the average and worst of both(the worst counts 1/16), weighted by
+  // MissPct. The sum of hit distances is exact, but keys wrapped from the table end are taken to be ahead of those
+  // hashed at the first buckets, while placeBuckets puts them behind, so the distances differ near the wrap
+  static uint64_t calcProbeCost(const std::vector<Bucket>& tmp_tbl, const HashParam& p, uint32_t* pos_cnt,
+                                HashT* hashes, uint64_t limit) {
+    uint64_t n = tmp_tbl.size(), size = (uint64_t)p.tbl_mask + 1;
+    for (uint64_t i = 0; i < n; i++) {
+      pos_cnt[hashes[i] = calcHash(tmp_tbl[i].key, p)]++;
+    }
+    // keys carried from the end of the table to the beginning
+    uint64_t carry = 0;
+    for (uint64_t i = 0; i < size; i++) {
+      carry = std::max<uint64_t>(carry + pos_cnt[i], 1) - 1;
+    }
+    uint64_t hit_sum = 0, hit_max = 0, miss_sum = 0, miss_max = 0, cost = 0;
+    for (uint64_t i = 0; i < size && cost < limit; i++) {
+      uint64_t reach = carry + pos_cnt[i];
+      if (pos_cnt[i]) hit_max = std::max(hit_max, reach - 1);
+      uint64_t scan = MaxProbeLen ? std::min<uint64_t>(reach, MaxProbeLen + 1) : reach;
+      miss_max = std::max(miss_max, scan);
+      miss_sum += scan;
+      carry = std::max<uint64_t>(reach, 1) - 1;
+      hit_sum += carry;
+      // the partial cost only grows
+      if ((i & 1023) == 1023) cost = probeScore(n, hit_sum, hit_max, size, miss_sum, miss_max);
+    }
+    cost = probeScore(n, hit_sum, hit_max, size, miss_sum, miss_max);
+    for (uint64_t i = 0; i < n; i++) pos_cnt[hashes[i]] = 0;
+    return cost;
+  }
+
+  // in 1/1024 buckets: hit_sum / n_hit and miss_sum / n_miss are the average probe distances
+  static uint64_t probeScore(uint64_t n_hit, uint64_t hit_sum, uint64_t hit_max, uint64_t n_miss, uint64_t miss_sum,
+                             uint64_t miss_max) {
+    uint64_t hit = n_hit ? hit_sum * 1024 / n_hit + hit_max * 64 : 0;
+    uint64_t miss = miss_sum * 1024 / n_miss + miss_max * 64;
+    return (100 - MissPct) * hit + MissPct * miss;
+  }
+};
+
+// StrHash is a std::map which can be modified freely, and a Table is trained from its keys by doneModify for fastFind.
+// the template parameters are the same as StrHashBuilder's
+template<size_t StrSZ, typename ValueT, ValueT NullV = 0, uint32_t HashFunc = 0, bool SmallTbl = true,
+         bool SoALayout = false, bool VarLen = false, char PadCh = '\0', uint32_t MaxProbeLen = 0,
+         uint32_t CostFunc = 0, uint32_t MissPct = 0>
+class StrHash : public std::map<Str<StrSZ>, ValueT>
+{
+public:
+  using Builder =
+    StrHashBuilder<StrSZ, ValueT, NullV, HashFunc, SmallTbl, SoALayout, VarLen, PadCh, MaxProbeLen, CostFunc, MissPct>;
+  using KeyT = typename Builder::KeyT;
+  using Parent = std::map<KeyT, ValueT>;
+  using HashT = typename Builder::HashT;
+  static const uint32_t MaxTblSZ = Builder::MaxTblSZ;
+  using Bucket = typename Builder::Bucket;
+  using HashParam = typename Builder::HashParam;
+  using Table = typename Builder::Table;
+
+  // n_threads: number of threads used to search for the best hashing parameters,
+  // the result is the same regardless of n_threads.
+  // sample_size: with more keys, parameters are searched on a sample of them, 0 to always search on all keys
+  bool doneModify(uint32_t n_threads = 1, uint64_t sample_size = Builder::TrainSampleSZ) {
+    return buildTable(table, n_threads, nullptr, sample_size);
+  }
+
+  // warm start from parameters trained before(e.g. on yesterday's keys, got by getHashParam()): they're evaluated
+  // first and used directly if good enough, otherwise the full search is done as above
+  bool doneModify(const HashParam& init_param, uint32_t n_threads = 1, uint64_t sample_size = Builder::TrainSampleSZ) {
+    return buildTable(table, n_threads, &init_param, sample_size);
+  }
+
+  // train a new table from the current keys without touching the one used by fastFind,
+  // so it can be done off to the side, e.g. for publishing to readers on other threads
+  bool buildTable(Table& t, uint32_t n_threads = 1, const HashParam* init_param = nullptr,
+                  uint64_t sample_size = Builder::TrainSampleSZ) const {
+    return Builder::build(t, Parent::begin(), Parent::end(), n_threads, init_param, sample_size);
+  }
+
+  ValueT fastFind(const KeyT& key) const { return table.fastFind(key); }
+
+  ValueT fastFind(const char* p, uint32_t len) const { return table.fastFind(p, len); }
+
+  // a VarLen key from len(<= StrSZ) chars at p, e.g. for emplace
+  static KeyT makeKey(const char* p, uint32_t len) { return Builder::makeKey(p, len); }
+
+  void fastFindBatch(const KeyT* keys, ValueT* values, uint32_t n) const { table.fastFindBatch(keys, values, n); }
+
+  void fastFindBatch(const KeyT* const* keys, ValueT* values, uint32_t n) const {
+    table.fastFindBatch(keys, values, n);
+  }
+
+  uint32_t getTableSize() const { return table.getTableSize(); }
+
+  const HashParam& getHashParam() const { return table.getHashParam(); }
+
+  const Table& getTable() const { return table; }
+
+  // save the table trained by doneModify
+  bool save(const char* path) const { return table.save(path); }
+
+  // load a saved table for fastFind instead of calling doneModify
+  bool load(const char* path, bool verify_checksum = true) { return table.load(path, verify_checksum); }
+
+private:
+  Table table;
 };
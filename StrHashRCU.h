@@ -0,0 +1,129 @@
+/*
+MIT License
+
+Copyright (c) 2019 Meng Rao <raomeng1@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+#pragma once
+#include "StrHash.h"
+
+// StrHashRCU publishes tables trained by a single writer thread to reader threads.
+// Readers never take a lock: each one announces the epoch it entered in its own slot, loads the current table and
+// searches in it. The writer swaps in a new table atomically and only deletes the old one after every reader that
+// entered before the swap has left.
+template<typename HashTbl, uint32_t MaxReaders = 64>
+class StrHashRCU
+{
+public:
+  using KeyT = typename HashTbl::KeyT;
+  using ValueT = typename HashTbl::mapped_type;
+  using Table = typename HashTbl::Table;
+
+  class Reader
+  {
+  public:
+    Reader() = default;
+    Reader(Reader&& other) : rcu(other.rcu), slot(other.slot) { other.rcu = nullptr; }
+    Reader& operator=(Reader&& other) {
+      std::swap(rcu, other.rcu);
+      std::swap(slot, other.slot);
+      return *this;
+    }
+    ~Reader() {
+      if (rcu) rcu->slots[slot].used.store(false, std::memory_order_release);
+    }
+
+    // false if there's no free slot when the Reader is got
+    bool valid() const { return rcu; }
+
+    ValueT fastFind(const KeyT& key) {
+      ValueT ret = enter()->fastFind(key);
+      leave();
+      return ret;
+    }
+
+    // all keys are searched in the same table
+    void fastFindBatch(const KeyT* keys, ValueT* values, uint32_t n) {
+      enter()->fastFindBatch(keys, values, n);
+      leave();
+    }
+
+    void fastFindBatch(const KeyT* const* keys, ValueT* values, uint32_t n) {
+      enter()->fastFindBatch(keys, values, n);
+      leave();
+    }
+
+  private:
+    friend class StrHashRCU;
+    Reader(StrHashRCU* r, uint32_t s) : rcu(r), slot(s) {}
+
+    const Table* enter() {
+      rcu->slots[slot].epoch.store(rcu->epoch.load());
+      return rcu->cur.load();
+    }
+
+    void leave() { rcu->slots[slot].epoch.store(0, std::memory_order_release); }
+
+    StrHashRCU* rcu = nullptr;
+    uint32_t slot;
+  };
+
+  StrHashRCU() {
+    Table* t = new Table;
+    HashTbl().buildTable(*t);
+    cur.store(t);
+  }
+
+  // all Readers must have been destroyed
+  ~StrHashRCU() { delete cur.load(); }
+
+  // called by each reader thread, a Reader should only be used by one thread at a time
+  Reader getReader() {
+    for (uint32_t i = 0; i < MaxReaders; i++) {
+      if (!slots[i].used.load(std::memory_order_relaxed) && !slots[i].used.exchange(true)) return Reader(this, i);
+    }
+    return Reader();
+  }
+
+  // train a new table from the keys of ht and publish it, the old table is deleted once no reader is using it.
+  // should be called from only one writer thread
+  bool publish(const HashTbl& ht, uint32_t n_threads = 1) {
+    std::unique_ptr<Table> t(new Table);
+    if (!ht.buildTable(*t, n_threads)) return false;
+    std::unique_ptr<const Table> old(cur.exchange(t.release()));
+    uint64_t e = epoch.fetch_add(1) + 1;
+    // readers entered at an epoch before e could be using the old table
+    for (auto& s : slots) {
+      for (uint64_t se; (se = s.epoch.load()) && se < e;) std::this_thread::yield();
+    }
+    return true;
+  }
+
+private:
+  struct alignas(64) Slot
+  {
+    std::atomic<uint64_t> epoch{0}; // 0 means not in read
+    std::atomic<bool> used{false};
+  };
+
+  alignas(64) std::atomic<const Table*> cur{nullptr};
+  alignas(64) std::atomic<uint64_t> epoch{1};
+  Slot slots[MaxReaders];
+};
@@ -15,6 +15,56 @@ void fillRand(Str<Size>& str) {
   }
 }
 
+// size -> kernel idx -> eq and compare ns
+map<int, map<int, pair<double, double>>> kernel_ns;
+
+// check every kernel against memcmp for each length and each position of the first different byte,
+// so all the stride and tail paths are covered
+void test_kernels() {
+  const int maxlen = 300;
+  char s1[maxlen], s2[maxlen];
+  for (int i = 0; i < maxlen; i++) s1[i] = s2[i] = 'a' + i % 26;
+  for (int k = 0; k < str_detail::CmpKernelCnt; k++) {
+    if (!str_detail::cmpKernelSupported(k)) continue;
+    auto& kernel = str_detail::getCmpKernel(k);
+    for (int len = 0; len <= maxlen; len++) {
+      assert(kernel.eq(s1, s2, len));
+      assert(kernel.compare(s1, s2, len) == 0);
+      for (int pos = 0; pos < len; pos++) {
+        for (int c : {'a' - 1, 'z' + 1, 0x80}) {
+          char bak = s2[pos];
+          s2[pos] = c;
+          int res = memcmp(s1, s2, len);
+          int kernel_res = kernel.compare(s1, s2, len);
+          assert((res > 0) == (kernel_res > 0) && (res < 0) == (kernel_res < 0));
+          assert(!kernel.eq(s1, s2, len));
+          s2[pos] = bak;
+        }
+      }
+    }
+  }
+}
+
+// check the specialized comparisons of small Str against memcmp for each position of the first different byte
+template<size_t Size>
+void test_small() {
+  Str<Size> s1, s2;
+  for (int i = 0; i < Size; i++) s1[i] = s2[i] = 'a' + i;
+  assert(s1 == s2 && s1.compare(s2) == 0 && !(s1 < s2));
+  for (int pos = 0; pos < Size; pos++) {
+    for (int c : {'a' - 1, 'z' + 1, 0x80}) {
+      char bak = s2[pos];
+      s2[pos] = c;
+      int res = memcmp(s1.s, s2.s, Size);
+      int compare_res = s1.compare(s2);
+      assert((res > 0) == (compare_res > 0) && (res < 0) == (compare_res < 0));
+      assert(!(s1 == s2));
+      assert((s1 < s2) == (res < 0) && (s2 < s1) == (res > 0));
+      s2[pos] = bak;
+    }
+  }
+}
+
 template<size_t Size>
 void bench() {
   const int datasize = 1000;
@@ -41,6 +91,14 @@ void bench() {
     assert(res == mem_res);
     assert(res == compare_res);
     assert((strs[i].first == strs[i].second) == (res == 0));
+    for (int k = 0; k < str_detail::CmpKernelCnt; k++) {
+      if (!str_detail::cmpKernelSupported(k)) continue;
+      auto& kernel = str_detail::getCmpKernel(k);
+      int kernel_res = kernel.compare(strs[i].first.s, strs[i].second.s, Size);
+      kernel_res = (kernel_res > 0) - (kernel_res < 0);
+      assert(res == kernel_res);
+      assert(kernel.eq(strs[i].first.s, strs[i].second.s, Size) == (res == 0));
+    }
   }
 
   {
@@ -67,6 +125,38 @@ void bench() {
     cout << "bench " << Size << " compare: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
   }
 
+  if (Size <= 16) {
+    // the runtime loop which the compile time specializations replace
+    uint64_t eq_sum = 0, cmp_sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& pr : strs) {
+        eq_sum += Str<Size>::genericEQ(pr.first.s, pr.second.s, Size);
+      }
+    }
+    auto mid = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& pr : strs) {
+        cmp_sum += Str<Size>::genericCompare(pr.first.s, pr.second.s, Size) < 0;
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " loop eq: " << (double)(mid - before) / (loop * datasize)
+         << " less: " << (double)(after - mid) / (loop * datasize) << " res: " << eq_sum << " " << cmp_sum << endl;
+  }
+
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& pr : strs) {
+        sum += pr.first < pr.second;
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " less: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+  }
+
   {
     uint64_t sum = 0;
     auto before = getns();
@@ -90,12 +180,55 @@ void bench() {
     auto after = getns();
     cout << "bench " << Size << " memcmp: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
   }
+
+  // each kernel supported by the running CPU, called through function pointers as the runtime dispatch does
+  for (int k = 0; k < str_detail::CmpKernelCnt; k++) {
+    if (!str_detail::cmpKernelSupported(k)) continue;
+    auto& kernel = str_detail::getCmpKernel(k);
+    uint64_t eq_sum = 0, cmp_sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& pr : strs) {
+        eq_sum += kernel.eq(pr.first.s, pr.second.s, Size);
+      }
+    }
+    auto mid = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& pr : strs) {
+        cmp_sum += kernel.compare(pr.first.s, pr.second.s, Size);
+      }
+    }
+    auto after = getns();
+    double eq_ns = (double)(mid - before) / (loop * datasize);
+    double cmp_ns = (double)(after - mid) / (loop * datasize);
+    cout << "bench " << Size << " kernel " << kernel.name << " eq: " << eq_ns << " compare: " << cmp_ns
+         << " res: " << eq_sum << " " << cmp_sum << endl;
+    kernel_ns[Size][k] = {eq_ns, cmp_ns};
+  }
   cout << endl;
 }
 
 
 int main() {
   srand(time(NULL));
+  test_kernels();
+  test_small<1>();
+  test_small<2>();
+  test_small<3>();
+  test_small<4>();
+  test_small<5>();
+  test_small<6>();
+  test_small<7>();
+  test_small<8>();
+  test_small<9>();
+  test_small<10>();
+  test_small<11>();
+  test_small<12>();
+  test_small<13>();
+  test_small<14>();
+  test_small<15>();
+  test_small<16>();
+  cout << "runtime dispatched kernel: " << str_detail::bestCmpKernel().name << endl << endl;
   bench<1>();
   bench<2>();
   bench<3>();
@@ -107,14 +240,30 @@ int main() {
   bench<13>();
   bench<15>();
   bench<16>();
+  bench<20>();
   bench<22>();
   bench<30>();
+  bench<32>();
+  bench<40>();
   bench<50>();
+  bench<64>();
   bench<100>();
   bench<128>();
   bench<300>();
   bench<500>();
   bench<999>();
+
+  cout << "kernel eq/compare ns:" << endl << "size";
+  for (int k = 0; k < str_detail::CmpKernelCnt; k++) {
+    if (str_detail::cmpKernelSupported(k)) cout << "\t" << str_detail::getCmpKernel(k).name;
+  }
+  cout << endl;
+  for (auto& row : kernel_ns) {
+    if (row.first < 16) continue;
+    cout << row.first;
+    for (auto& col : row.second) cout << "\t" << col.second.first << "/" << col.second.second;
+    cout << endl;
+  }
 }
 
 
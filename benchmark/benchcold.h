@@ -0,0 +1,27 @@
+#pragma once
+#include <bits/stdc++.h>
+
+// cache cold search latency shared by the benches: the cache is evicted before each search by reading a buffer larger
+// than LLC, and only the search itself is timed
+std::vector<char> evict_buf(64 << 20, 1);
+uint64_t evict_sum = 0;
+void evictCache() {
+  for (size_t i = 0; i < evict_buf.size(); i += 64) evict_sum += evict_buf[i];
+}
+
+// search keys[i % keys.size()] in ht cnt times, print the sum of found values and the average latency
+template<typename HashTbl, typename Key>
+void benchCold(const char* name, uint32_t hash_func, const HashTbl& ht, const std::vector<Key>& keys, int cnt = 200) {
+  auto getns = []() -> uint64_t { return std::chrono::high_resolution_clock::now().time_since_epoch().count(); };
+  int64_t sum = 0;
+  uint64_t total = 0;
+  for (int i = 0; i < cnt; i++) {
+    auto& key = keys[i % keys.size()];
+    evictCache();
+    getns(); // warm up the clock itself
+    auto before = getns();
+    sum += ht.fastFind(key);
+    total += getns() - before;
+  }
+  std::cout << name << " " << hash_func << " sum: " << sum << " avg lat: " << (double)total / cnt << std::endl;
+}
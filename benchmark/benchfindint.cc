@@ -1,5 +1,6 @@
 #include <bits/stdc++.h>
 #include "../StrHash.h"
+#include "benchcold.h"
 #include "tsl/robin_map.h"
 #include "tsl/hopscotch_map.h"
 #include "robin_hood.h"
@@ -39,9 +40,9 @@ const int loop = 1000;
 vector<IntT> tbl_data;
 vector<IntT> find_data;
 
-template<uint32_t HashFunc>
+template<uint32_t HashFunc, bool SoALayout = false>
 void bench_hash() {
-  StrHash<IntLen, Value, 0, HashFunc> ht;
+  StrHash<IntLen, Value, 0, HashFunc, true, SoALayout> ht;
   for (int i = 0; i < tbl_data.size(); i++) {
     ht.emplace((const char*)&tbl_data[i], i + 1);
   }
@@ -57,10 +58,23 @@ void bench_hash() {
     }
   }
   auto after = getns();
-  cout << "bench_hash " << HashFunc << " sum: " << sum
+  cout << (SoALayout ? "bench_hash_soa " : "bench_hash ") << HashFunc << " sum: " << sum
        << " avg lat: " << (double)(after - before) / (loop * find_data.size()) << endl;
 }
 
+// the default vs SoALayout table with the cache evicted before each search
+template<uint32_t HashFunc, bool SoALayout>
+void bench_hash_cold() {
+  StrHash<IntLen, Value, 0, HashFunc, true, SoALayout> ht;
+  for (int i = 0; i < tbl_data.size(); i++) {
+    ht.emplace((const char*)&tbl_data[i], i + 1);
+  }
+  ht.doneModify();
+  vector<Key> keys;
+  for (auto s : find_data) keys.push_back(*(const Key*)&s);
+  benchCold(SoALayout ? "bench_hash_soa_cold" : "bench_hash_cold", HashFunc, ht, keys);
+}
+
 template<typename T>
 void bench_map() {
   T ht;
@@ -152,6 +166,9 @@ int main() {
   bench_hash<4>();
   bench_hash<5>();
   bench_hash<6>(); // 6 is for integer key
+  bench_hash<6, true>();
+  bench_hash_cold<6, false>();
+  bench_hash_cold<6, true>();
   bench_map<map<IntT, Value>>();
   bench_map<unordered_map<IntT, Value>>();
   bench_map<
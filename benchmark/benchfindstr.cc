@@ -1,5 +1,6 @@
 #include <bits/stdc++.h>
 #include "../StrHash.h"
+#include "benchcold.h"
 #include "tsl/robin_map.h"
 #include "tsl/hopscotch_map.h"
 #include "robin_hood.h"
@@ -38,9 +39,9 @@ const int loop = 1000;
 std::vector<std::string> tbl_data;
 std::vector<std::string> find_data;
 
-template<uint32_t HashFunc>
+template<uint32_t HashFunc, bool SoALayout = false>
 void bench_hash() {
-  StrHash<STR_LEN, Value, 0, HashFunc, true> ht;
+  StrHash<STR_LEN, Value, 0, HashFunc, true, SoALayout> ht;
   for (int i = 0; i < tbl_data.size(); i++) {
     ht.emplace(tbl_data[i].data(), i + 1);
   }
@@ -59,10 +60,136 @@ void bench_hash() {
     }
   }
   auto after = getns();
-  cout << "bench_hash " << HashFunc << " sum: " << sum
+  cout << (SoALayout ? "bench_hash_soa " : "bench_hash ") << HashFunc << " sum: " << sum
+       << " avg lat: " << (double)(after - before) / (loop * find_data.size()) << endl;
+}
+
+// keys are looked up in packets of PacketSZ, as if decoded from market data packets
+template<uint32_t HashFunc, uint32_t PacketSZ = 32>
+void bench_hash_batch() {
+  StrHash<STR_LEN, Value, 0, HashFunc, true> ht;
+  for (int i = 0; i < tbl_data.size(); i++) {
+    ht.emplace(tbl_data[i].data(), i + 1);
+  }
+  if (!ht.doneModify()) {
+    cout << "table size too large, try using template parameter SmallTbl=false" << endl;
+    return;
+  }
+  int n = find_data.size();
+  vector<Key> keys(n);
+  vector<const Key*> key_ptrs(n);
+  vector<Value> values(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = find_data[i].data();
+    key_ptrs[i] = (const Key*)find_data[i].data();
+  }
+
+  {
+    int64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (int i = 0; i < n; i += PacketSZ) {
+        ht.fastFindBatch(&keys[i], &values[i], std::min(PacketSZ, (uint32_t)(n - i)));
+      }
+      for (auto v : values) sum += v;
+    }
+    auto after = getns();
+    cout << "bench_hash_batch " << HashFunc << " sum: " << sum << " avg lat: " << (double)(after - before) / (loop * n)
+         << endl;
+  }
+
+  {
+    int64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (int i = 0; i < n; i += PacketSZ) {
+        ht.fastFindBatch(&key_ptrs[i], &values[i], std::min(PacketSZ, (uint32_t)(n - i)));
+      }
+      for (auto v : values) sum += v;
+    }
+    auto after = getns();
+    cout << "bench_hash_batch_ptr " << HashFunc << " sum: " << sum
+         << " avg lat: " << (double)(after - before) / (loop * n) << endl;
+  }
+}
+
+// save the trained table into a file and mmap it back, as another process would do at startup
+template<uint32_t HashFunc, bool SoALayout = false>
+void bench_hash_file() {
+  using HashTbl = StrHash<STR_LEN, Value, 0, HashFunc, true, SoALayout>;
+  const char* path = "benchfindstr.tbl";
+  {
+    HashTbl built, ht;
+    for (int i = 0; i < tbl_data.size(); i++) {
+      built.emplace(tbl_data[i].data(), i + 1);
+    }
+    if (!built.doneModify()) {
+      cout << "failed to save table" << endl;
+      return;
+    }
+    ht = std::move(built);
+    if (!ht.save(path)) {
+      cout << "failed to save table" << endl;
+      return;
+    }
+  }
+  HashTbl loaded;
+  auto before = getns();
+  bool ok = loaded.load(path);
+  auto after = getns();
+  // the mapping moves with the table and is unmapped once
+  HashTbl ht(std::move(loaded));
+  assert(loaded.getTableSize() == 0);
+  // files saved with different template parameters are rejected
+  assert(!(StrHash<STR_LEN, uint32_t, 0, HashFunc, true, SoALayout>().load(path)));
+  assert(!(StrHash<STR_LEN, Value, 0, (HashFunc + 1) % 6, true, SoALayout>().load(path)));
+  assert(!(StrHash<STR_LEN, Value, 0, HashFunc, true, !SoALayout>().load(path)));
+  if (ok) {
+    // a hash_pos out of the key is rejected even if the checksum is not verified
+    auto param = ht.getHashParam();
+    ifstream in(path, ios::binary);
+    string file((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    size_t off = file.find(string((const char*)&param, sizeof(param)));
+    assert(off != string::npos);
+    ((typename HashTbl::HashParam*)&file[off])->hash_pos[0] = STR_LEN;
+    ofstream(path, ios::binary).write(file.data(), file.size());
+    assert(!HashTbl().load(path, false));
+  }
+  remove(path);
+  if (!ok) {
+    cout << "failed to load table" << endl;
+    return;
+  }
+  for (int i = 0; i < tbl_data.size(); i++) {
+    assert(ht.fastFind(*(const Key*)tbl_data[i].data()) == i + 1);
+  }
+  double load_us = (double)(after - before) / 1000;
+
+  int64_t sum = 0;
+  before = getns();
+  for (int l = 0; l < loop; l++) {
+    for (auto& s : find_data) {
+      sum += ht.fastFind(*(const Key*)s.data());
+    }
+  }
+  after = getns();
+  cout << (SoALayout ? "bench_hash_soa_file " : "bench_hash_file ") << HashFunc << " load us: " << load_us << " sum: " << sum
        << " avg lat: " << (double)(after - before) / (loop * find_data.size()) << endl;
 }
 
+// the default vs SoALayout table with the cache evicted before each search
+template<uint32_t HashFunc, bool SoALayout>
+void bench_hash_cold() {
+  StrHash<STR_LEN, Value, 0, HashFunc, true, SoALayout> ht;
+  for (int i = 0; i < tbl_data.size(); i++) {
+    ht.emplace(tbl_data[i].data(), i + 1);
+  }
+  ht.doneModify();
+  vector<Key> keys;
+  for (auto& s : find_data) keys.push_back(*(const Key*)s.data());
+  benchCold(SoALayout ? "bench_hash_soa_cold" : "bench_hash_cold", HashFunc, ht, keys);
+}
+
 void bench_map() {
   StrHash<STR_LEN, Value> ht; // StrHash is itself a std::map
   for (int i = 0; i < tbl_data.size(); i++) {
@@ -119,6 +246,8 @@ void bench_dense_map() {
        << ", sum: " << sum << " avg lat: " << (double)(after - before) / (loop * find_data.size()) << endl;
 }
 
+// LoopCmp uses the generic comparison loop instead of Str::compare, to show the gain of compile time specialization
+template<bool LoopCmp = false>
 void bench_bsearch() {
   int n = tbl_data.size();
   vector<pair<Key, Value>> vec(n);
@@ -135,7 +264,7 @@ void bench_bsearch() {
       int l = 0, r = n - 1;
       while (l <= r) {
         int m = (l + r) >> 1;
-        int cmp = key.compare(vec[m].first);
+        int cmp = LoopCmp ? Key::genericCompare(key.s, vec[m].first.s, Key::Size) : key.compare(vec[m].first);
         if (cmp == 0) {
           sum += vec[m].second;
           break;
@@ -148,7 +277,7 @@ void bench_bsearch() {
     }
   }
   auto after = getns();
-  cout << "bench_bsearch sum: " << sum << " avg lat: " << (double)(after - before) / (loop * find_data.size()) << endl;
+  cout << (LoopCmp ? "bench_bsearch_loop" : "bench_bsearch") << " sum: " << sum << " avg lat: " << (double)(after - before) / (loop * find_data.size()) << endl;
 }
 
 void bench_string_bsearch() {
@@ -202,6 +331,14 @@ int main(int argc, char** argv) {
   bench_hash<3>();
   bench_hash<4>();
   bench_hash<5>();
+  bench_hash<0, true>();
+  bench_hash<3, true>();
+  bench_hash_cold<0, false>();
+  bench_hash_cold<0, true>();
+  bench_hash_batch<0>();
+  bench_hash_batch<3>();
+  bench_hash_file<0>();
+  bench_hash_file<0, true>();
   bench_map();
   bench_string_map<map<string, Value>>();
   bench_string_map<unordered_map<string, Value>>();
@@ -212,6 +349,7 @@ int main(int argc, char** argv) {
   bench_string_map<robin_hood::unordered_map<string, Value>>();
   bench_dense_map();
   bench_bsearch();
+  bench_bsearch<true>();
   bench_string_bsearch();
 
   return 0;
@@ -0,0 +1,125 @@
+#include <bits/stdc++.h>
+#include "../StrHash.h"
+
+using namespace std;
+
+inline uint64_t getns() {
+  return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+// a mixed universe of 6 char equities, 12 char options and 13 ~ 21 char derivatives in one VarLen StrHash
+const int STR_LEN = 21;
+
+using Key = Str<STR_LEN>;
+using Value = uint16_t;
+const int loop = 1000;
+std::vector<std::string> tbl_data;
+std::vector<std::string> find_data;
+std::vector<Value> expected;
+
+template<uint32_t HashFunc, bool SoALayout = false, char PadCh = '\0'>
+void bench_hash_var() {
+  using HashTbl = StrHash<STR_LEN, Value, 0, HashFunc, true, SoALayout, true, PadCh>;
+  HashTbl ht;
+  for (int i = 0; i < tbl_data.size(); i++) {
+    ht.emplace(HashTbl::makeKey(tbl_data[i].data(), tbl_data[i].size()), i + 1);
+  }
+  if (!ht.doneModify()) {
+    cout << "table size too large, try using template parameter SmallTbl=false" << endl;
+    return;
+  }
+  for (int i = 0; i < find_data.size(); i++) {
+    assert(ht.fastFind(find_data[i].data(), find_data[i].size()) == expected[i]);
+    assert(ht.fastFind(HashTbl::makeKey(find_data[i].data(), find_data[i].size())) == expected[i]);
+  }
+  // longer than StrSZ
+  assert(ht.fastFind("0123456789012345678901", 22) == 0);
+
+  int64_t sum = 0;
+  auto before = getns();
+  for (int l = 0; l < loop; l++) {
+    for (auto& s : find_data) {
+      sum += ht.fastFind(s.data(), s.size());
+    }
+  }
+  auto after = getns();
+  cout << (SoALayout ? "bench_hash_var_soa " : "bench_hash_var ") << HashFunc << " pad: " << (int)PadCh
+       << " sum: " << sum << " avg lat: " << (double)(after - before) / (loop * find_data.size())
+       << " table size: " << ht.getHashParam().tbl_mask + 1 << " hash pos len: " << ht.getHashParam().hash_pos_len
+       << endl;
+}
+
+// the caller pads each key into a Str before fastFind
+template<uint32_t HashFunc>
+void bench_hash_padded() {
+  using HashTbl = StrHash<STR_LEN, Value, 0, HashFunc, true, false, true>;
+  HashTbl ht;
+  for (int i = 0; i < tbl_data.size(); i++) {
+    ht.emplace(HashTbl::makeKey(tbl_data[i].data(), tbl_data[i].size()), i + 1);
+  }
+  ht.doneModify();
+  int64_t sum = 0;
+  auto before = getns();
+  for (int l = 0; l < loop; l++) {
+    for (auto& s : find_data) {
+      Key key;
+      memset(key.s, 0, STR_LEN);
+      memcpy(key.s, s.data(), s.size());
+      sum += ht.fastFind(key);
+    }
+  }
+  auto after = getns();
+  cout << "bench_hash_padded " << HashFunc << " sum: " << sum
+       << " avg lat: " << (double)(after - before) / (loop * find_data.size()) << endl;
+}
+
+template<typename Map>
+void bench_string_map() {
+  Map mp;
+  for (int i = 0; i < tbl_data.size(); i++) {
+    mp.emplace(tbl_data[i], i + 1);
+  }
+  int64_t sum = 0;
+  auto before = getns();
+  for (int l = 0; l < loop; l++) {
+    for (auto& s : find_data) {
+      auto it = mp.find(s);
+      if (it != mp.end()) sum += it->second;
+    }
+  }
+  auto after = getns();
+  cout << "bench_string_map " << typeid(Map).name() << " sum: " << sum
+       << " avg lat: " << (double)(after - before) / (loop * find_data.size()) << endl;
+}
+
+int main(int argc, char** argv) {
+  int n;
+  cin >> n;
+  tbl_data.resize(n);
+  for (int i = 0; i < n; i++) {
+    cin >> tbl_data[i];
+  }
+  cin >> n;
+  find_data.resize(n);
+  for (int i = 0; i < n; i++) {
+    cin >> find_data[i];
+  }
+  unordered_map<string, Value> ref;
+  for (int i = 0; i < tbl_data.size(); i++) ref.emplace(tbl_data[i], i + 1);
+  for (auto& s : find_data) {
+    auto it = ref.find(s);
+    expected.push_back(it == ref.end() ? 0 : it->second);
+  }
+
+  bench_hash_var<0>();
+  bench_hash_var<1>();
+  bench_hash_var<3>();
+  bench_hash_var<5>();
+  bench_hash_var<0, true>();
+  bench_hash_var<0, false, ' '>();
+  bench_hash_padded<0>();
+  bench_string_map<map<string, Value>>();
+  bench_string_map<unordered_map<string, Value>>();
+
+  return 0;
+}
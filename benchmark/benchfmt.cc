@@ -0,0 +1,152 @@
+#include <bits/stdc++.h>
+#include "../Str.h"
+using namespace std;
+
+inline uint64_t getns() {
+  return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+// a FIX like new order message with fixed width numeric fields, which are filled by StrFields vs per field fromi
+const char* msg_template = "8=FIX.4.2|9=0000|35=D|34=00000000|49=SENDER|56=TARGET|52=20261018-09:30:00.000|"
+                           "11=0000000000000000|1=000000000000|55=000000|38=00000000|44=0000000000|110=00000000|"
+                           "54=1|40=2|59=0|60=00000000000000000000|10=000|";
+
+// tag and width of each numeric field in the order of the message
+const vector<pair<string, uint32_t>> field_defs = {{"|9=", 4},     {"|34=", 8},  {"|11=", 16}, {"|1=", 12},
+                                                   {"|55=", 6},    {"|38=", 8},  {"|44=", 10}, {"|110=", 8},
+                                                   {"|60=", 20},   {"|10=", 3}};
+const int FieldCnt = 10;
+
+vector<StrField> fields;
+
+// the baseline: each field is written by Str<width>::fromi with the width known at compile time
+struct Offsets
+{
+  uint32_t o[FieldCnt];
+};
+
+void formatByFromi(char* buf, const Offsets& off, const uint64_t* nums) {
+  ((Str<4>*)(buf + off.o[0]))->fromi(nums[0]);
+  ((Str<8>*)(buf + off.o[1]))->fromi(nums[1]);
+  ((Str<16>*)(buf + off.o[2]))->fromi(nums[2]);
+  ((Str<12>*)(buf + off.o[3]))->fromi(nums[3]);
+  ((Str<6>*)(buf + off.o[4]))->fromi(nums[4]);
+  ((Str<8>*)(buf + off.o[5]))->fromi(nums[5]);
+  ((Str<10>*)(buf + off.o[6]))->fromi(nums[6]);
+  ((Str<8>*)(buf + off.o[7]))->fromi(nums[7]);
+  ((Str<20>*)(buf + off.o[8]))->fromi(nums[8]);
+  ((Str<3>*)(buf + off.o[9]))->fromi(nums[9]);
+}
+
+// per field fromi when the layout is only known at runtime, dispatched by the width
+template<size_t... W>
+void fromiByWidth(char* p, uint32_t width, uint64_t num, index_sequence<W...>) {
+  static void (*const tbl[])(char*, uint64_t) = {[](char* p, uint64_t num) { ((Str<W + 1>*)p)->fromi(num); }...};
+  tbl[width - 1](p, num);
+}
+
+void formatByWidth(char* buf, const uint64_t* nums) {
+  for (int i = 0; i < FieldCnt; i++) {
+    fromiByWidth(buf + fields[i].offset, fields[i].width, nums[i], make_index_sequence<20>());
+  }
+}
+
+// N fields of the widths separated by '|'
+template<size_t N>
+void testWidths(const array<uint32_t, N>& widths, mt19937_64& rng) {
+  char buf[128];
+  StrField fs[N];
+  uint64_t vs[N];
+  uint32_t offset = 1;
+  for (uint32_t i = 0; i < N; i++) {
+    fs[i] = {offset, widths[i]};
+    offset += widths[i] + 1;
+    vs[i] = rng();
+  }
+  memset(buf, '|', sizeof(buf));
+  StrFields<N>(fs).fromi(buf, vs);
+  for (uint32_t i = 0; i < N; i++) {
+    uint32_t width = fs[i].width;
+    string expect = to_string(vs[i]);
+    if (expect.size() > width) expect = expect.substr(expect.size() - width);
+    expect = string(width - expect.size(), '0') + expect;
+    assert(string(buf + fs[i].offset, width) == expect);
+    assert(buf[fs[i].offset - 1] == '|' && buf[fs[i].offset + width] == '|');
+  }
+}
+
+int main() {
+  srand(time(NULL));
+  string tmpl = msg_template;
+  const size_t MsgLen = tmpl.size();
+  Offsets off;
+  for (int i = 0; i < FieldCnt; i++) {
+    size_t pos = tmpl.find(field_defs[i].first);
+    assert(pos != string::npos);
+    uint32_t offset = pos + field_defs[i].first.size();
+    assert(tmpl[offset + field_defs[i].second] == '|');
+    fields.push_back({offset, field_defs[i].second});
+    off.o[i] = offset;
+  }
+
+  const int msgs = 64;
+  const int loop = 2000;
+  const int rounds = 20;
+  mt19937_64 rng(rand());
+  vector<uint64_t> nums(msgs * FieldCnt);
+  for (int m = 0; m < msgs; m++) {
+    for (int i = 0; i < FieldCnt; i++) {
+      uint64_t mod = 1;
+      for (int j = 0; j < fields[i].width && j < 19; j++) mod *= 10;
+      // some values are wider than the field, only the lowest digits are written
+      nums[m * FieldCnt + i] = rng() % (i == 0 ? mod : mod * 3);
+    }
+  }
+  vector<char> bufs1(msgs * MsgLen), bufs2(msgs * MsgLen);
+  for (int m = 0; m < msgs; m++) {
+    memcpy(&bufs1[m * MsgLen], tmpl.data(), MsgLen);
+    memcpy(&bufs2[m * MsgLen], tmpl.data(), MsgLen);
+  }
+  StrFields<FieldCnt> fmt(fields.data());
+  for (int m = 0; m < msgs; m++) {
+    formatByFromi(&bufs1[m * MsgLen], off, &nums[m * FieldCnt]);
+    fmt.fromi(&bufs2[m * MsgLen], &nums[m * FieldCnt]);
+  }
+  assert(bufs1 == bufs2);
+  for (int m = 0; m < msgs; m++) {
+    formatByWidth(&bufs2[m * MsgLen], &nums[m * FieldCnt]);
+  }
+  assert(bufs1 == bufs2);
+  // every width, alone and mixed with others, with the neighbouring chars untouched
+  for (uint32_t width = 1; width <= 20; width++) {
+    testWidths<1>({width}, rng);
+    testWidths<3>({width, width, width}, rng);
+    testWidths<5>({width, 21 - width, 8, width, 3}, rng);
+  }
+
+  // ns per message of format(buf, nums) over all messages
+  auto timeFormat = [&](char* buf, auto format) {
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (int m = 0; m < msgs; m++) {
+        format(buf + m * MsgLen, &nums[m * FieldCnt]);
+      }
+      asm volatile("" : : "r"(buf) : "memory");
+    }
+    auto after = getns();
+    return (double)(after - before) / (loop * msgs);
+  };
+  // the methods take turns for some rounds and the best of each is reported, as a single run is easily disturbed
+  double best[3] = {1e9, 1e9, 1e9};
+  for (int r = 0; r < rounds; r++) {
+    best[0] = min(best[0], timeFormat(bufs1.data(), [&](char* buf, const uint64_t* v) { formatByFromi(buf, off, v); }));
+    best[1] = min(best[1], timeFormat(bufs2.data(), [](char* buf, const uint64_t* v) { formatByWidth(buf, v); }));
+    best[2] = min(best[2], timeFormat(bufs2.data(), [&](char* buf, const uint64_t* v) { fmt.fromi(buf, v); }));
+  }
+  const char* names[] = {"fromi per field", "fromi per field by runtime width", "StrFields"};
+  for (int k = 0; k < 3; k++) {
+    cout << "bench " << names[k] << ": " << best[k] << " ns/msg, " << 1000 / best[k] << " M msgs/s" << endl;
+  }
+  assert(bufs1 == bufs2);
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include <bits/stdc++.h>
+#include "../StrHash.h"
+
+using namespace std;
+
+inline uint64_t getns() {
+  return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+// tens of millions of synthetic 12 digit order IDs which are increasing with gaps, built by StrHashBuilder from arrays.
+// searched keys are shuffled hits and misses(an ID + 1, which is always in a gap)
+const int STR_LEN = 12;
+
+using Key = Str<STR_LEN>;
+using Value = uint32_t;
+
+vector<Key> keys;
+vector<Value> values;
+vector<Key> hits, misses;
+
+template<uint32_t HashFunc, uint32_t MaxProbeLen>
+void bench_large() {
+  using Builder = StrHashBuilder<STR_LEN, Value, 0, HashFunc, false, false, false, '\0', MaxProbeLen>;
+  typename Builder::Table t;
+  auto before = getns();
+  bool ok = Builder::build(t, keys.data(), values.data(), keys.size());
+  auto after = getns();
+  if (!ok) {
+    // MaxProbeLen can't be met before the table is too large
+    cout << "bench_large " << HashFunc << " MaxProbeLen: " << MaxProbeLen << " keys: " << keys.size()
+         << " build failed" << endl;
+    return;
+  }
+  auto hist = t.getProbeHist();
+  uint64_t sum_dist = 0;
+  for (uint64_t d = 0; d < hist.size(); d++) sum_dist += d * hist[d];
+  assert(!MaxProbeLen || hist.size() <= MaxProbeLen + 1);
+
+  int64_t sum = 0;
+  auto t1 = getns();
+  for (auto& key : hits) sum += t.fastFind(key);
+  auto t2 = getns();
+  for (auto& key : misses) sum += t.fastFind(key);
+  auto t3 = getns();
+  int64_t expect = 0;
+  for (auto& key : hits) expect += key.toi64() % 1000000007;
+  assert(sum == expect);
+
+  cout << "bench_large " << HashFunc << " MaxProbeLen: " << MaxProbeLen << " keys: " << keys.size()
+       << " build ms: " << (double)(after - before) / 1000000 << " table size: " << t.getHashParam().tbl_mask + 1
+       << " max probe: " << hist.size() - 1 << " avg probe: " << (double)sum_dist / keys.size()
+       << " hit lat: " << (double)(t2 - t1) / hits.size() << " miss lat: " << (double)(t3 - t2) / misses.size()
+       << endl;
+}
+
+// a miss whose hash value wraps around the table end doesn't scan the keys of low hash values placed at the start:
+// keys 0..29998 and 32767 fill a 32768 bucket table of integer keys, 65535 hashes to the last bucket and is a miss
+template<bool SoALayout>
+void bench_wrap_miss() {
+  using Builder = StrHashBuilder<4, uint32_t, 0, 6, true, SoALayout, false, '\0', 1>;
+  vector<Str<4>> wrap_keys;
+  vector<uint32_t> wrap_values;
+  for (uint32_t i = 0; i <= 29998; i++) wrap_keys.push_back(*(const Str<4>*)&i);
+  uint32_t last = 32767, miss = 65535;
+  wrap_keys.push_back(*(const Str<4>*)&last);
+  for (uint32_t i = 0; i < wrap_keys.size(); i++) wrap_values.push_back(i + 1);
+  typename Builder::Table t;
+  bool ok = Builder::build(t, wrap_keys.data(), wrap_values.data(), wrap_keys.size());
+  assert(ok);
+  for (uint32_t i = 0; i < wrap_keys.size(); i++) assert(t.fastFind(wrap_keys[i]) == i + 1);
+  const int loop = 100000;
+  uint64_t sum = 0;
+  auto before = getns();
+  for (int l = 0; l < loop; l++) sum += t.fastFind(*(const Str<4>*)&miss);
+  auto after = getns();
+  assert(sum == 0);
+  cout << (SoALayout ? "bench_wrap_miss_soa" : "bench_wrap_miss") << " table size: " << t.getHashParam().tbl_mask + 1
+       << " max probe: " << t.getProbeHist().size() - 1 << " miss lat: " << (double)(after - before) / loop << endl;
+}
+
+int main(int argc, char** argv) {
+  srand(time(NULL));
+  vector<uint64_t> sizes;
+  for (int i = 1; i < argc; i++) sizes.push_back(atoll(argv[i]));
+  // e.g. ./benchlarge 10000000 50000000, a table of 50M keys needs about 8GB memory
+  if (sizes.empty()) sizes.push_back(10000000);
+  bench_wrap_miss<false>();
+  bench_wrap_miss<true>();
+  for (uint64_t n : sizes) {
+    mt19937_64 rng(rand());
+    keys.resize(n);
+    values.resize(n);
+    uint64_t id = 100000000000ULL + rng() % 100000000000ULL;
+    for (uint64_t i = 0; i < n; i++) {
+      id += 2 + rng() % 7;
+      keys[i].fromi(id);
+    }
+    shuffle(keys.begin(), keys.end(), rng);
+    for (uint64_t i = 0; i < n; i++) values[i] = keys[i].toi64() % 1000000007;
+    hits.resize(1000000);
+    misses.resize(1000000);
+    for (auto& key : hits) key = keys[rng() % n];
+    for (auto& key : misses) key.fromi(keys[rng() % n].toi64() + 1);
+
+    bench_large<0, 0>();
+    bench_large<7, 0>();
+    bench_large<7, 6>();
+  }
+  return 0;
+}
@@ -20,8 +20,9 @@ char buf[1024];
 template<uint32_t Size>
 void bench() {
   using NumStr = Str<Size>;
+  // 20 digits cover the whole range of uint64
   uint64_t mod = 1;
-  for (int i = 0; i < Size; i++) mod *= 10;
+  for (int i = 0; i < Size && i < 19; i++) mod *= 10;
 
   const int datasize = 1000;
   const int loop = 1000;
@@ -32,17 +33,19 @@ void bench() {
     uint64_t num = getRand();
     num <<= 32;
     num += getRand();
-    num %= mod;
+    if (Size < 20) num %= mod;
     string str = to_string(num);
     while (str.size() < Size) str = string("0") + str;
     NumStr numstr = str.data();
     assert(numstr.toi64() == num);
-    assert(stoll(str) == num);
-    assert(strtoll(str.data(), NULL, 10) == num);
+    assert(stoull(str) == num);
+    assert(strtoull(str.data(), NULL, 10) == num);
     NumStr teststr;
     teststr.fromi(num);
     assert(teststr == numstr);
-    sprintf(buf, "%0*lld", Size, num);
+    teststr.simdfromi(num);
+    assert(teststr == numstr);
+    sprintf(buf, "%0*llu", Size, (unsigned long long)num);
     assert(str == buf);
     nums[i] = num;
     strs[i] = numstr;
@@ -66,11 +69,11 @@ void bench() {
     auto before = getns();
     for (int l = 0; l < loop; l++) {
       for (auto& str : strings) {
-        sum += stoll(str);
+        sum += stoull(str);
       }
     }
     auto after = getns();
-    cout << "bench " << Size << " stoll: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+    cout << "bench " << Size << " stoull: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
   }
 
   {
@@ -78,11 +81,11 @@ void bench() {
     auto before = getns();
     for (int l = 0; l < loop; l++) {
       for (auto& str : strings) {
-        sum += strtoll(str.data(), NULL, 10);
+        sum += strtoull(str.data(), NULL, 10);
       }
     }
     auto after = getns();
-    cout << "bench " << Size << " strtoll: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+    cout << "bench " << Size << " strtoull: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
   }
 
   {
@@ -104,6 +107,49 @@ void bench() {
     cout << "bench " << Size << " fromi: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
   }
 
+  {
+    union
+    {
+      uint64_t num;
+      char str[Size];
+    } res;
+    res.num = 0;
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto num : nums) {
+        (*(NumStr*)res.str).simdfromi(num);
+        sum += res.num;
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " simdfromi: " << (double)(after - before) / (loop * datasize) << " res: " << sum
+         << endl;
+  }
+
+  // throughput without reading the result back
+  {
+    vector<NumStr> out(datasize);
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (int i = 0; i < datasize; i++) {
+        out[i].fromi(nums[i]);
+      }
+      asm volatile("" : : "r"(out.data()) : "memory");
+    }
+    auto after = getns();
+    cout << "bench " << Size << " fromi array: " << (double)(after - before) / (loop * datasize) << endl;
+    before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (int i = 0; i < datasize; i++) {
+        out[i].simdfromi(nums[i]);
+      }
+      asm volatile("" : : "r"(out.data()) : "memory");
+    }
+    after = getns();
+    cout << "bench " << Size << " simdfromi array: " << (double)(after - before) / (loop * datasize) << endl;
+  }
+
   {
     auto before = getns();
     for (int l = 0; l < loop; l++) {
@@ -120,7 +166,7 @@ void bench() {
     auto before = getns();
     for (int l = 0; l < loop; l++) {
       for (auto num : nums) {
-        sprintf(buf, "%0*lld", Size, num);
+        sprintf(buf, "%0*llu", Size, (unsigned long long)num);
       }
     }
     auto after = getns();
@@ -131,6 +177,521 @@ void bench() {
   cout << endl;
 }
 
+// tosi only compiles for up to 10 digits, the signed values fit int32 for up to 9 digits
+template<uint32_t Size>
+typename enable_if<(Size <= 10)>::type check_tosi(const Str<Size>& numstr, int64_t num) {
+  assert(numstr.tosi() == num);
+}
+
+template<uint32_t Size>
+typename enable_if<(Size > 10)>::type check_tosi(const Str<Size>& numstr, int64_t num) {}
+
+// fields of a sign followed by Size - 1 zero padded digits, round trip against strtoll and snprintf
+template<uint32_t Size>
+void bench_signed() {
+  using NumStr = Str<Size>;
+  int64_t mod = 1;
+  for (int i = 0; i < Size - 1; i++) mod *= 10;
+
+  const int datasize = 1000;
+  const int loop = 1000;
+  vector<int64_t> nums(datasize);
+  vector<NumStr> strs(datasize);
+  vector<string> strings(datasize);
+  for (int i = 0; i < datasize; i++) {
+    uint64_t r = getRand();
+    r <<= 32;
+    r += getRand();
+    int64_t num = r % mod;
+    if (rand() & 1) num = -num;
+    snprintf(buf, sizeof(buf), "%+0*lld", Size, (long long)num);
+    string str = buf;
+    assert(str.size() == Size);
+    NumStr numstr = str.data();
+    assert(numstr.tosi64() == num);
+    assert(strtoll(str.data(), NULL, 10) == num);
+    check_tosi<Size>(numstr, num);
+    NumStr teststr;
+    teststr.fromsi(num);
+    assert(teststr == numstr);
+    nums[i] = num;
+    strs[i] = numstr;
+    strings[i] = str;
+  }
+  {
+    // positive sign other than '+'
+    NumStr teststr;
+    teststr.fromsi(mod - 1, ' ');
+    assert(teststr[0] == ' ' && teststr.tosi64() == mod - 1);
+    teststr.fromsi(1 - mod);
+    assert(teststr[0] == '-' && teststr.tosi64() == 1 - mod);
+  }
+
+  {
+    int64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& str : strs) {
+        sum += str.tosi64();
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " tosi64: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+  }
+
+  {
+    int64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& str : strings) {
+        sum += strtoll(str.data(), NULL, 10);
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " strtoll: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+  }
+
+  {
+    union
+    {
+      uint64_t num[3];
+      char str[Size];
+    } res;
+    res.num[0] = res.num[1] = res.num[2] = 0;
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto num : nums) {
+        (*(NumStr*)res.str).fromsi(num);
+        sum += res.num[0];
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " fromsi: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+  }
+
+  {
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto num : nums) {
+        snprintf(buf, sizeof(buf), "%+0*lld", Size, (long long)num);
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " snprintf: " << (double)(after - before) / (loop * datasize) << " res: " << buf
+         << endl;
+  }
+
+  cout << endl;
+}
+
+// space padded fields parsed by toi64<Pad> vs the normalize-then-toi64 approach: replace spaces with '0', and for
+// left justified fields move the digits to the end first
+template<uint32_t Size, StrPad Pad>
+void bench_pad() {
+  using NumStr = Str<Size>;
+  uint64_t mod = 1;
+  for (int i = 0; i < Size; i++) mod *= 10;
+
+  const int datasize = 1000;
+  const int loop = 1000;
+  vector<uint64_t> nums(datasize);
+  vector<NumStr> strs(datasize);
+  for (int i = 0; i < datasize; i++) {
+    uint64_t num = getRand();
+    num <<= 32;
+    num += getRand();
+    // various lengths of digits
+    num %= mod;
+    num >>= rand() % 64;
+    snprintf(buf, sizeof(buf), Pad == PadSpace ? "%*llu" : "%-*llu", Size, (unsigned long long)num);
+    NumStr numstr = buf;
+    assert(numstr.template toi64<Pad>() == num);
+    if (Size <= 9) assert(numstr.template toi<Pad>() == num);
+    NumStr teststr;
+    teststr.template fromi<Pad>(num);
+    assert(teststr == numstr);
+    nums[i] = num;
+    strs[i] = numstr;
+  }
+  {
+    // all spaces is 0
+    NumStr teststr;
+    memset(teststr.s, ' ', Size);
+    assert(teststr.template toi64<Pad>() == 0);
+  }
+
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& str : strs) {
+        sum += str.template toi64<Pad>();
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << (Pad == PadSpace ? " space" : " trailing") << " toi64: "
+         << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+  }
+
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& str : strs) {
+        NumStr norm;
+        if (Pad == PadSpace) {
+          for (int i = 0; i < Size; i++) norm[i] = str[i] == ' ' ? '0' : str[i];
+        }
+        else {
+          int n = Size;
+          while (n > 0 && str[n - 1] == ' ') n--;
+          memset(norm.s, '0', Size - n);
+          memcpy(norm.s + Size - n, str.s, n);
+        }
+        sum += norm.toi64();
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << (Pad == PadSpace ? " space" : " trailing") << " normalize toi64: "
+         << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+  }
+
+  {
+    union
+    {
+      uint64_t num[3];
+      char str[Size];
+    } res;
+    res.num[0] = res.num[1] = res.num[2] = 0;
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto num : nums) {
+        (*(NumStr*)res.str).template fromi<Pad>(num);
+        sum += res.num[0];
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << (Pad == PadSpace ? " space" : " trailing") << " fromi: "
+         << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+  }
+
+  cout << endl;
+}
+
+// fixed point prices with Decimals implied decimals, tofix vs strtod and parsing the 2 parts by toi64 separately
+template<uint32_t Size, uint32_t Decimals>
+void bench_fix() {
+  using NumStr = Str<Size>;
+  const uint32_t IntSize = Size - 1 - Decimals;
+  uint64_t mod = 1, scale = 1;
+  for (int i = 0; i < Size - 1; i++) mod *= 10;
+  for (int i = 0; i < Decimals; i++) scale *= 10;
+
+  const int datasize = 1000;
+  const int loop = 1000;
+  vector<uint64_t> nums(datasize);
+  vector<NumStr> strs(datasize);
+  for (int i = 0; i < datasize; i++) {
+    uint64_t num = getRand();
+    num <<= 32;
+    num += getRand();
+    num %= mod;
+    snprintf(buf, sizeof(buf), "%0*llu.%0*llu", IntSize, (unsigned long long)(num / scale), Decimals,
+             (unsigned long long)(num % scale));
+    NumStr numstr = buf;
+    assert(numstr.template tofix<Decimals>() == num);
+    assert((numstr.template tofix<Decimals, true>() == num));
+    if (Size - 1 <= 15) assert(llround(strtod(buf, NULL) * scale) == num);
+    NumStr teststr;
+    teststr.template fromfix<Decimals>(num);
+    assert(teststr == numstr);
+    // a detected point with fewer or more decimals, or no point at all, padded with spaces
+    uint32_t dec = rand() % (Size - 1);
+    uint64_t dec_scale = 1;
+    for (int j = 0; j < dec; j++) dec_scale *= 10;
+    uint64_t int_part = (num / dec_scale) % (mod / dec_scale), frac = num % dec_scale;
+    if (dec)
+      snprintf(buf, sizeof(buf), "%*llu.%0*llu", Size - 1 - dec, (unsigned long long)int_part, dec,
+               (unsigned long long)frac);
+    else
+      snprintf(buf, sizeof(buf), "%*llu", Size, (unsigned long long)int_part);
+    uint64_t expected = int_part * scale;
+    if (dec <= Decimals)
+      expected += frac * (scale / dec_scale);
+    else
+      expected += frac / (dec_scale / scale);
+    assert((NumStr(buf).template tofix<Decimals, true>() == expected));
+    nums[i] = num;
+    strs[i] = numstr;
+  }
+
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& str : strs) {
+        sum += str.template tofix<Decimals>();
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " decimals " << Decimals << " tofix: " << (double)(after - before) / (loop * datasize)
+         << " res: " << sum << endl;
+  }
+
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& str : strs) {
+        sum += str.template tofix<Decimals, true>();
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " decimals " << Decimals
+         << " tofix detect point: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+  }
+
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& str : strs) {
+        sum += ((const Str<IntSize>*)str.s)->toi64() * scale + ((const Str<Decimals>*)(str.s + IntSize + 1))->toi64();
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " decimals " << Decimals
+         << " split toi64: " << (double)(after - before) / (loop * datasize) << " res: " << sum << endl;
+  }
+
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& str : strs) {
+        // strtod needs a null terminated string
+        memcpy(buf, str.s, Size);
+        buf[Size] = 0;
+        sum += llround(strtod(buf, NULL) * scale);
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " decimals " << Decimals << " strtod: " << (double)(after - before) / (loop * datasize)
+         << " res: " << sum << endl;
+  }
+
+  {
+    union
+    {
+      uint64_t num[3];
+      char str[Size];
+    } res;
+    res.num[0] = res.num[1] = res.num[2] = 0;
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto num : nums) {
+        (*(NumStr*)res.str).template fromfix<Decimals>(num);
+        sum += res.num[0];
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " decimals " << Decimals << " fromfix: " << (double)(after - before) / (loop * datasize)
+         << " res: " << sum << endl;
+  }
+
+  {
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto num : nums) {
+        snprintf(buf, sizeof(buf), "%0*.*f", Size, Decimals, (double)num / scale);
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " decimals " << Decimals << " snprintf: " << (double)(after - before) / (loop * datasize)
+         << " res: " << buf << endl;
+  }
+
+  cout << endl;
+}
+
+// checked toi64 which validates the digits vs the unchecked one
+template<uint32_t Size>
+void bench_checked() {
+  using NumStr = Str<Size>;
+  uint64_t mod = 1;
+  for (int i = 0; i < Size && i < 19; i++) mod *= 10;
+
+  const int datasize = 1000;
+  const int loop = 1000;
+  vector<NumStr> strs(datasize);
+  for (int i = 0; i < datasize; i++) {
+    uint64_t num = getRand();
+    num <<= 32;
+    num += getRand();
+    if (Size < 20) num %= mod;
+    snprintf(buf, sizeof(buf), "%0*llu", Size, (unsigned long long)num);
+    NumStr numstr = buf;
+    uint64_t res;
+    assert(numstr.toi64(res) && res == num);
+    if (Size <= 9) {
+      uint32_t res32;
+      assert(numstr.toi(res32) && res32 == num);
+    }
+    strs[i] = numstr;
+  }
+  // every non digit char at every position is detected
+  for (int pos = 0; pos < Size; pos++) {
+    for (int c = 0; c < 256; c++) {
+      if (c >= '0' && c <= '9') continue;
+      NumStr numstr = strs[pos];
+      numstr[pos] = c;
+      uint64_t res;
+      assert(!numstr.toi64(res));
+      uint32_t res32;
+      assert(!numstr.toi(res32));
+    }
+  }
+  if (Size == 10) {
+    // toi doesn't narrow a number above UINT32_MAX
+    uint32_t res32;
+    assert(NumStr("4294967295").toi(res32) && res32 == UINT32_MAX);
+    assert(!NumStr("4294967296").toi(res32));
+    assert(!NumStr("9999999999").toi(res32));
+  }
+  if (Size == 20) {
+    // overflow of 20 digits
+    uint64_t res;
+    assert(NumStr("18446744073709551615").toi64(res) && res == UINT64_MAX);
+    assert(NumStr("10000000000000000000").toi64(res) && res == 10000000000000000000ULL);
+    assert(!NumStr("18446744073709551616").toi64(res));
+    assert(!NumStr("18446744083709551615").toi64(res));
+    assert(!NumStr("19000000000000000000").toi64(res));
+    assert(!NumStr("99999999999999999999").toi64(res));
+    NumStr teststr;
+    teststr.fromi(UINT64_MAX);
+    assert(teststr == "18446744073709551615");
+    teststr.simdfromi(UINT64_MAX);
+    assert(teststr == "18446744073709551615");
+  }
+
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& str : strs) {
+        sum += str.toi64();
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " unchecked toi64: " << (double)(after - before) / (loop * datasize) << " res: " << sum
+         << endl;
+  }
+
+  {
+    uint64_t sum = 0, bad = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (auto& str : strs) {
+        uint64_t num;
+        bad += !str.toi64(num);
+        sum += num;
+      }
+    }
+    auto after = getns();
+    cout << "bench " << Size << " checked toi64: " << (double)(after - before) / (loop * datasize) << " res: " << sum
+         << " bad: " << bad << endl;
+  }
+
+  cout << endl;
+}
+
+// toi64Batch over a Str<Size> array and over a field inside an array of records vs a loop of toi64
+template<uint32_t Size>
+void bench_batch() {
+  using NumStr = Str<Size>;
+  uint64_t mod = 1;
+  for (int i = 0; i < Size && i < 19; i++) mod *= 10;
+
+  struct Record
+  {
+    char head[13];
+    NumStr field;
+    char tail[64 - 13 - Size];
+  };
+  // not a multiple of 8 to cover the scalar tail
+  const int datasize = 4099;
+  const int loop = 1000;
+  vector<NumStr> strs(datasize);
+  vector<Record> records(datasize);
+  vector<uint64_t> nums(datasize), out(datasize);
+  for (int i = 0; i < datasize; i++) {
+    uint64_t num = getRand();
+    num <<= 32;
+    num += getRand();
+    if (Size < 20) num %= mod;
+    nums[i] = num;
+    strs[i].fromi(num);
+    memset(&records[i], 'x', sizeof(Record));
+    records[i].field = strs[i];
+  }
+  for (int n = 0; n <= 20; n++) {
+    fill(out.begin(), out.end(), 0);
+    NumStr::toi64Batch(strs.data(), out.data(), n);
+    assert(equal(out.begin(), out.begin() + n, nums.begin()) && out[n] == 0);
+  }
+  NumStr::toi64Batch(strs.data(), out.data(), datasize);
+  assert(out == nums);
+  fill(out.begin(), out.end(), 0);
+  NumStr::toi64Batch(records[0].field.s, sizeof(Record), out.data(), datasize);
+  assert(out == nums);
+
+  auto report = [&](const char* name, uint64_t ns, uint64_t sum) {
+    double values = (double)loop * datasize;
+    cout << "bench " << Size << " " << name << ": " << ns / values << " ns, " << values * Size / ns << " GB/s, "
+         << values / ns * 1000 << " M values/s, res: " << sum << endl;
+  };
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (int i = 0; i < datasize; i++) out[i] = strs[i].toi64();
+      sum += out[l % datasize];
+    }
+    report("toi64 loop", getns() - before, sum);
+  }
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      NumStr::toi64Batch(strs.data(), out.data(), datasize);
+      sum += out[l % datasize];
+    }
+    report("toi64Batch", getns() - before, sum);
+  }
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      for (int i = 0; i < datasize; i++) out[i] = records[i].field.toi64();
+      sum += out[l % datasize];
+    }
+    report("record toi64 loop", getns() - before, sum);
+  }
+  {
+    uint64_t sum = 0;
+    auto before = getns();
+    for (int l = 0; l < loop; l++) {
+      NumStr::toi64Batch(records[0].field.s, sizeof(Record), out.data(), datasize);
+      sum += out[l % datasize];
+    }
+    report("record toi64Batch", getns() - before, sum);
+  }
+
+  cout << endl;
+}
 
 int main() {
   srand(time(NULL));
@@ -152,5 +713,64 @@ int main() {
   bench<16>();
   bench<17>();
   bench<18>();
+  bench<19>();
+  bench<20>();
+
+  bench_signed<2>();
+  bench_signed<4>();
+  bench_signed<7>();
+  bench_signed<9>();
+  bench_signed<11>();
+  bench_signed<13>();
+  bench_signed<17>();
+  bench_signed<19>();
+
+  bench_pad<4, PadSpace>();
+  bench_pad<8, PadSpace>();
+  bench_pad<10, PadSpace>();
+  bench_pad<16, PadSpace>();
+  bench_pad<19, PadSpace>();
+  bench_pad<4, PadTrailing>();
+  bench_pad<8, PadTrailing>();
+  bench_pad<10, PadTrailing>();
+  bench_pad<16, PadTrailing>();
+  bench_pad<19, PadTrailing>();
+
+  bench_fix<10, 2>();
+  bench_fix<16, 2>();
+  bench_fix<10, 4>();
+  bench_fix<16, 4>();
+  bench_fix<12, 8>();
+  bench_fix<16, 8>();
+  bench_fix<19, 8>();
+
+  bench_checked<1>();
+  bench_checked<2>();
+  bench_checked<3>();
+  bench_checked<4>();
+  bench_checked<5>();
+  bench_checked<6>();
+  bench_checked<7>();
+  bench_checked<8>();
+  bench_checked<9>();
+  bench_checked<10>();
+  bench_checked<11>();
+  bench_checked<12>();
+  bench_checked<13>();
+  bench_checked<14>();
+  bench_checked<15>();
+  bench_checked<16>();
+  bench_checked<17>();
+  bench_checked<18>();
+  bench_checked<19>();
+  bench_checked<20>();
+
+  bench_batch<4>();
+  bench_batch<8>();
+  bench_batch<10>();
+  bench_batch<12>();
+  bench_batch<16>();
+  bench_batch<18>();
+  bench_batch<20>();
 }
 
@@ -0,0 +1,114 @@
+#include <bits/stdc++.h>
+#include "../StrHashRCU.h"
+
+using namespace std;
+
+inline uint64_t getns() {
+  return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+// stress test of one writer publishing tables while reader threads searching:
+// in version v the table contains keys [0, BaseKeys + v), with value (v << 16) | key_idx, readers check that each
+// batch of lookups is served by a single version which is not older than the one published before the batch started
+
+const int STR_LEN = 12;
+
+using Key = Str<STR_LEN>;
+using Value = uint32_t;
+using HashTbl = StrHash<STR_LEN, Value>;
+using RCU = StrHashRCU<HashTbl>;
+
+const int BaseKeys = 1000;
+const int Versions = 200;
+const int QueryKeys = 64;
+
+vector<Key> keys;
+RCU rcu;
+atomic<int> published_ver{0};
+atomic<bool> done{false};
+
+void writer() {
+  HashTbl ht;
+  for (int i = 0; i < BaseKeys; i++) {
+    ht.emplace(keys[i], i);
+  }
+  uint64_t total_ns = 0;
+  for (int v = 1; v <= Versions; v++) {
+    // a new listing, and all values updated to the new version
+    ht.emplace(keys[BaseKeys + v - 1], 0);
+    for (auto& pr : ht) {
+      pr.second = (v << 16) | (pr.second & 0xffff);
+    }
+    ht[keys[BaseKeys + v - 1]] = (v << 16) | (BaseKeys + v - 1);
+    auto before = getns();
+    bool ok = rcu.publish(ht);
+    total_ns += getns() - before;
+    assert(ok);
+    published_ver.store(v, memory_order_release);
+  }
+  done = true;
+  cout << "writer versions: " << Versions << " avg publish us: " << (double)total_ns / Versions / 1000 << endl;
+}
+
+void reader(int id) {
+  RCU::Reader rd = rcu.getReader();
+  assert(rd.valid());
+  mt19937 rng(id);
+  // keys 0 and 1 are always present once published, the rest are spread over the listings added during the test
+  Key query[QueryKeys];
+  int query_idx[QueryKeys];
+  Value values[QueryKeys];
+  int last_ver = 0;
+  uint64_t batches = 0;
+  while (!done) {
+    for (int i = 0; i < QueryKeys; i++) {
+      query_idx[i] = i < 2 ? i : rng() % (BaseKeys + Versions);
+      query[i] = keys[query_idx[i]];
+    }
+    int pub_ver = published_ver.load(memory_order_acquire);
+    rd.fastFindBatch(query, values, QueryKeys);
+    int ver = values[0] >> 16;
+    assert(ver >= pub_ver);   // not stale
+    assert(ver >= last_ver);  // never goes back
+    for (int i = 0; i < QueryKeys; i++) {
+      bool present = ver > 0 && query_idx[i] < BaseKeys + ver; // version 0 is the initial empty table
+      if (present) {
+        assert(values[i] == ((ver << 16) | query_idx[i])); // same version for the whole batch
+      }
+      else {
+        assert(values[i] == 0);
+      }
+    }
+    last_ver = ver;
+    batches++;
+  }
+  // single lookups after the last version is published
+  for (int i = 0; i < BaseKeys + Versions; i++) {
+    assert(rd.fastFind(keys[i]) == ((Versions << 16) | i));
+  }
+  cout << "reader " << id << " batches: " << batches << " last ver: " << last_ver << endl;
+}
+
+int main(int argc, char** argv) {
+  int n_readers = argc > 1 ? atoi(argv[1]) : 4;
+  keys.resize(BaseKeys + Versions);
+  for (int i = 0; i < keys.size(); i++) {
+    keys[i] = "KR4000000000";
+    Str<8> num;
+    num.fromi(i * 7919);
+    memcpy(&keys[i][4], num.s, 8);
+  }
+  {
+    // the initial table is empty
+    RCU::Reader rd = rcu.getReader();
+    assert(rd.fastFind(keys[0]) == 0);
+  }
+  vector<thread> readers;
+  for (int i = 0; i < n_readers; i++) {
+    readers.emplace_back(reader, i);
+  }
+  writer();
+  for (auto& thr : readers) thr.join();
+  cout << "done" << endl;
+  return 0;
+}
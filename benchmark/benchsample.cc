@@ -0,0 +1,69 @@
+#include <bits/stdc++.h>
+#include "../StrHash.h"
+
+using namespace std;
+
+inline uint64_t getns() {
+  return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+// training on all keys vs on samples of different sizes with the best TrainTopK validated on all keys,
+// for 1M generated KRX-like issue codes
+const int STR_LEN = 12;
+
+using Key = Str<STR_LEN>;
+using Value = uint32_t;
+
+// generate n distinct KRX option like issue codes, e.g. KR4201P22150
+vector<Key> genKeys(int n) {
+  const char* alnum = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  set<Key> keys;
+  while (keys.size() < n) {
+    Key key = "KR4000000000";
+    key[3] = '0' + rand() % 3;
+    key[4] = '0' + rand() % 10;
+    key[5] = '1' + rand() % 2;
+    key[6] = "CPQ"[rand() % 3];
+    for (int i = 7; i < STR_LEN - 1; i++) key[i] = alnum[rand() % 36];
+    key[STR_LEN - 1] = '0' + rand() % 10;
+    keys.insert(key);
+  }
+  vector<Key> ret(keys.begin(), keys.end());
+  shuffle(ret.begin(), ret.end(), mt19937(rand()));
+  return ret;
+}
+
+template<uint32_t HashFunc>
+void bench_sample(const vector<Key>& keys, uint64_t sample_size) {
+  using Builder = StrHashBuilder<STR_LEN, Value, 0, HashFunc, false>;
+  vector<Value> values(keys.size());
+  for (int i = 0; i < keys.size(); i++) values[i] = i + 1;
+  typename Builder::Table t;
+  auto before = getns();
+  bool ok = Builder::build(t, keys.data(), values.data(), keys.size(), 1, nullptr, sample_size);
+  auto after = getns();
+  assert(ok);
+  for (int i = 0; i < keys.size(); i++) {
+    assert(t.fastFind(keys[i]) == i + 1);
+  }
+  auto hist = t.getProbeHist();
+  uint64_t sum_dist = 0;
+  for (uint64_t d = 0; d < hist.size(); d++) sum_dist += d * hist[d];
+  auto& param = t.getHashParam();
+  cout << "bench_sample " << HashFunc << " keys: " << keys.size() << " sample: " << (sample_size ? to_string(sample_size) : "all")
+       << " train ms: " << (double)(after - before) / 1000000 << " table size: " << param.tbl_mask + 1
+       << " hash pos len: " << param.hash_pos_len << " salt: " << param.hash_salt
+       << " avg probe: " << (double)sum_dist / keys.size() << " probe hist:";
+  for (uint64_t cnt : hist) cout << " " << cnt;
+  cout << endl;
+}
+
+int main() {
+  srand(time(NULL));
+  auto keys = genKeys(1000000);
+  for (uint64_t sample_size : {0, 1 << 18, 1 << 16}) {
+    bench_sample<0>(keys, sample_size);
+    bench_sample<7>(keys, sample_size);
+  }
+  return 0;
+}
@@ -0,0 +1,253 @@
+#include <bits/stdc++.h>
+#include "../StrHash.h"
+#include <malloc.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+inline uint64_t getns() {
+  return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+const int STR_LEN = 12;
+
+using Key = Str<STR_LEN>;
+using Value = uint32_t;
+
+// generate n distinct KRX option like issue codes, e.g. KR4201P22150
+vector<Key> genKeys(int n) {
+  const char* alnum = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  set<Key> keys;
+  while (keys.size() < n) {
+    Key key = "KR4000000000";
+    key[3] = '0' + rand() % 3;
+    key[4] = '0' + rand() % 10;
+    key[5] = '1' + rand() % 2;
+    key[6] = "CPQ"[rand() % 3];
+    for (int i = 7; i < STR_LEN - 1; i++) key[i] = alnum[rand() % 36];
+    key[STR_LEN - 1] = '0' + rand() % 10;
+    keys.insert(key);
+  }
+  vector<Key> ret(keys.begin(), keys.end());
+  shuffle(ret.begin(), ret.end(), mt19937(rand()));
+  return ret;
+}
+
+template<uint32_t HashFunc, bool SmallTbl>
+void bench_train(const vector<Key>& keys) {
+  StrHash<STR_LEN, Value, 0, HashFunc, SmallTbl> ht;
+  for (int i = 0; i < keys.size(); i++) {
+    ht.emplace(keys[i], i + 1);
+  }
+  auto before = getns();
+  bool ok = ht.doneModify();
+  auto after = getns();
+  assert(ok);
+  for (int i = 0; i < keys.size(); i++) {
+    assert(ht.fastFind(keys[i]) == i + 1);
+  }
+  cout << "bench_train " << HashFunc << " SmallTbl: " << SmallTbl << " keys: " << keys.size()
+       << " doneModify ms: " << (double)(after - before) / 1000000 << endl;
+}
+
+// train the same keys with different number of threads, each result should be identical to the single threaded one
+template<uint32_t HashFunc, bool SmallTbl>
+void bench_train_threads(const vector<Key>& keys) {
+  using HashTbl = StrHash<STR_LEN, Value, 0, HashFunc, SmallTbl>;
+  double base_ms = 0;
+  typename HashTbl::HashParam base_param;
+  for (uint32_t n_threads : {1, 2, 4, 8}) {
+    HashTbl ht;
+    for (int i = 0; i < keys.size(); i++) {
+      ht.emplace(keys[i], i + 1);
+    }
+    auto before = getns();
+    bool ok = ht.doneModify(n_threads);
+    auto after = getns();
+    assert(ok);
+    for (int i = 0; i < keys.size(); i++) {
+      assert(ht.fastFind(keys[i]) == i + 1);
+    }
+    auto& param = ht.getHashParam();
+    if (n_threads == 1) base_param = param;
+    assert(param.hash_salt == base_param.hash_salt && param.tbl_mask == base_param.tbl_mask &&
+           param.hash_pos_len == base_param.hash_pos_len &&
+           equal(param.hash_pos, param.hash_pos + param.hash_pos_len, base_param.hash_pos));
+    double ms = (double)(after - before) / 1000000;
+    if (n_threads == 1) base_ms = ms;
+    cout << "bench_train_threads " << HashFunc << " SmallTbl: " << SmallTbl << " keys: " << keys.size()
+         << " threads: " << n_threads << " doneModify ms: " << ms << " speedup: " << base_ms / ms << endl;
+  }
+}
+
+// day 2 universe has 2% keys delisted and 2% newly listed vs day 1, and is trained with day 1's parameters as warm start
+template<uint32_t HashFunc, bool SmallTbl>
+void bench_train_warm(int n) {
+  using HashTbl = StrHash<STR_LEN, Value, 0, HashFunc, SmallTbl>;
+  auto keys = genKeys(n + n / 50);
+  typename HashTbl::HashParam param;
+  {
+    HashTbl ht;
+    for (int i = 0; i < n; i++) {
+      ht.emplace(keys[i], i + 1);
+    }
+    ht.doneModify();
+    param = ht.getHashParam();
+  }
+  double ms[2];
+  for (int warm = 0; warm < 2; warm++) {
+    HashTbl ht;
+    for (int i = n / 50; i < keys.size(); i++) {
+      ht.emplace(keys[i], i + 1);
+    }
+    auto before = getns();
+    bool ok = warm ? ht.doneModify(param) : ht.doneModify();
+    auto after = getns();
+    assert(ok);
+    for (int i = 0; i < keys.size(); i++) {
+      assert(ht.fastFind(keys[i]) == (i < n / 50 ? 0 : i + 1));
+    }
+    ms[warm] = (double)(after - before) / 1000000;
+  }
+  cout << "bench_train_warm " << HashFunc << " SmallTbl: " << SmallTbl << " keys: " << n << " cold ms: " << ms[0]
+       << " warm ms: " << ms[1] << endl;
+}
+
+// VmRSS or VmHWM(peak) in KB
+long readStatus(const char* field) {
+  ifstream f("/proc/self/status");
+  string line;
+  while (getline(f, line)) {
+    if (line.rfind(field, 0) == 0) return stol(line.substr(strlen(field) + 1));
+  }
+  return -1;
+}
+
+// peak RSS increase and time of building a table from keys by StrHash(std::map then doneModify) vs
+// StrHashBuilder::build from arrays, each in a child process with the peak reset(by /proc/self/clear_refs)
+template<uint32_t HashFunc, bool SmallTbl>
+void bench_build_rss(const vector<Key>& keys) {
+  using HashTbl = StrHash<STR_LEN, Value, 0, HashFunc, SmallTbl>;
+  using Builder = typename HashTbl::Builder;
+  vector<Value> values(keys.size());
+  for (int i = 0; i < keys.size(); i++) values[i] = i + 1;
+  {
+    // both paths train the same table
+    HashTbl ht;
+    for (int i = 0; i < keys.size(); i++) ht.emplace(keys[i], values[i]);
+    assert(ht.doneModify());
+    typename HashTbl::Table t;
+    assert(Builder::build(t, keys.data(), values.data(), keys.size()));
+    assert(t.getHashParam().tbl_mask == ht.getHashParam().tbl_mask &&
+           t.getHashParam().hash_salt == ht.getHashParam().hash_salt &&
+           t.getHashParam().hash_pos_len == ht.getHashParam().hash_pos_len);
+    for (int i = 0; i < keys.size(); i++) assert(t.fastFind(keys[i]) == i + 1);
+    // from a vector of pairs
+    vector<pair<Key, Value>> prs;
+    for (int i = 0; i < 100; i++) prs.emplace_back(keys[i], values[i]);
+    typename HashTbl::Table t2;
+    assert(Builder::build(t2, prs.begin(), prs.end()));
+    for (int i = 0; i < keys.size(); i++) assert(t2.fastFind(keys[i]) == (i < 100 ? i + 1 : 0));
+    // duplicate keys are rejected and t2 is untouched
+    prs.push_back(prs[0]);
+    assert(!Builder::build(t2, prs.begin(), prs.end()));
+    assert(t2.getTableSize() == 100 && t2.fastFind(keys[99]) == 100);
+  }
+  for (int use_builder = 0; use_builder < 2; use_builder++) {
+    cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+      malloc_trim(0);
+      ofstream("/proc/self/clear_refs") << "5";
+      long base_kb = readStatus("VmRSS:");
+      auto before = getns();
+      if (use_builder) {
+        typename HashTbl::Table t;
+        assert(Builder::build(t, keys.data(), values.data(), keys.size()));
+      }
+      else {
+        HashTbl ht;
+        for (int i = 0; i < keys.size(); i++) ht.emplace(keys[i], values[i]);
+        assert(ht.doneModify());
+      }
+      auto after = getns();
+      long peak_kb = readStatus("VmHWM:");
+      cout << "bench_build_rss " << HashFunc << " SmallTbl: " << SmallTbl << " keys: " << keys.size()
+           << (use_builder ? " StrHashBuilder::build" : " StrHash::doneModify")
+           << " ms: " << (double)(after - before) / 1000000 << " peak RSS increase MB: " << (peak_kb - base_kb) / 1024.0
+           << endl;
+      _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+}
+
+// training by the sum of squared bucket occupancy vs by the probe distances of hits and misses, searched with 30% of
+// keys not in the table
+template<uint32_t CostFunc, uint32_t MissPct>
+void bench_cost(const vector<Key>& keys, const vector<Key>& queries) {
+  using HashTbl = StrHash<STR_LEN, Value, 0, 0, false, false, false, '\0', 0, CostFunc, MissPct>;
+  HashTbl ht;
+  for (int i = 0; i < keys.size(); i++) {
+    ht.emplace(keys[i], i + 1);
+  }
+  auto before = getns();
+  bool ok = ht.doneModify();
+  auto after = getns();
+  assert(ok);
+  int64_t expect = 0;
+  for (int i = 0; i < keys.size(); i++) {
+    assert(ht.fastFind(keys[i]) == i + 1);
+  }
+  for (auto& key : queries) {
+    auto it = ht.find(key);
+    if (it != ht.end()) expect += it->second;
+  }
+  auto hist = ht.getTable().getProbeHist();
+  uint64_t sum_dist = 0;
+  for (uint64_t d = 0; d < hist.size(); d++) sum_dist += d * hist[d];
+  const int loop = 100;
+  int64_t sum = 0;
+  auto t1 = getns();
+  for (int l = 0; l < loop; l++) {
+    for (auto& key : queries) sum += ht.fastFind(key);
+  }
+  auto t2 = getns();
+  assert(sum == expect * loop);
+  cout << "bench_cost " << CostFunc << " MissPct: " << MissPct << " keys: " << keys.size()
+       << " doneModify ms: " << (double)(after - before) / 1000000 << " table size: " << ht.getHashParam().tbl_mask + 1
+       << " hash pos len: " << ht.getHashParam().hash_pos_len << " avg probe: " << (double)sum_dist / keys.size()
+       << " max probe: " << hist.size() - 1 << " avg lat: " << (double)(t2 - t1) / (loop * queries.size()) << endl;
+}
+
+int main() {
+  srand(time(NULL));
+  for (int n : {1000, 10000}) {
+    auto keys = genKeys(n);
+    bench_train<0, true>(keys);
+    bench_train<3, true>(keys);
+    bench_train<0, false>(keys);
+  }
+  {
+    auto keys = genKeys(100000);
+    bench_train<0, false>(keys);
+    bench_train<3, false>(keys);
+    bench_train_threads<0, false>(keys);
+    bench_build_rss<0, false>(keys);
+  }
+  {
+    // 30% of queries are not in the table
+    auto all = genKeys(100000 + 100000 * 3 / 7);
+    vector<Key> keys(all.begin(), all.begin() + 100000);
+    vector<Key> queries(all.begin(), all.end());
+    shuffle(queries.begin(), queries.end(), mt19937(rand()));
+    bench_cost<0, 0>(keys, queries);
+    bench_cost<1, 0>(keys, queries);
+    bench_cost<1, 30>(keys, queries);
+  }
+  bench_train_warm<0, true>(10000);
+  bench_train_warm<0, false>(100000);
+  return 0;
+}
@@ -1,6 +1,12 @@
 g++ -std=c++17 -march=native -O3 -I. benchfindstr.cc -o benchfindstr
 # run: ./benchfindstr < data.txt
 
+g++ -std=c++17 -march=native -O3 -pthread -I. benchtrain.cc -o benchtrain
+# run: ./benchtrain
+
+g++ -std=c++17 -march=native -O3 -pthread -I. benchrcu.cc -o benchrcu
+# run: ./benchrcu [n_readers]
+
 g++ -std=c++17 -march=native -O3 -I. benchfindint.cc -o benchfindint
 # run: ./benchfindint < integers.txt
 
@@ -10,3 +16,15 @@ g++ -march=native -O3 benchnum.cc -o benchnum
 g++ -march=native -O3 benchcmp.cc -o benchcmp
 # run: ./benchcmp
 
+
+g++ -march=native -O3 benchfmt.cc -o benchfmt
+# run: ./benchfmt
+
+g++ -std=c++17 -march=native -O3 -I. benchfindvar.cc -o benchfindvar
+# run: ./benchfindvar < data_mixed.txt
+
+g++ -std=c++17 -march=native -O3 -pthread -I. benchlarge.cc -o benchlarge
+# run: ./benchlarge [n_keys...]
+
+g++ -std=c++17 -march=native -O3 -pthread -I. benchsample.cc -o benchsample
+# run: ./benchsample